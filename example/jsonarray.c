@@ -0,0 +1,218 @@
+#define _POSIX_C_SOURCE 200809L
+#include "../jsmn.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * An example of parsing one large JSON array from stdin on several threads:
+ *
+ * 1. every thread scans a chunk of the input with jsmn_scan_chunk(),
+ * 2. jsmn_split_array() finds where the array elements of each chunk begin,
+ * 3. every thread parses its part with jsmn_parse_array_part(),
+ * 4. jsmn_join_array_part() puts the tokens together in order.
+ *
+ * The resulting tokens are the same as from jsmn_parse().
+ *
+ * Usage: jsonarray [threads] < data.json   - parse and count tokens
+ *        jsonarray -b [max] < data.json    - throughput for 1, 2, 4 ... threads
+ */
+
+struct job {
+  const char *js;
+  size_t len;
+  jsmn_chunk *chunks;
+  unsigned int num_chunks;
+  unsigned int index;
+  int phase;         /* 1 - scan the chunk, 2 - parse the part */
+  jsmntok_t *tokens; /* tokens of the part */
+  jsmnuint_t num_tokens;
+  jsmnint_t count;
+};
+
+static void *work(void *arg) {
+  struct job *job = arg;
+  jsmn_parser parser;
+
+  if (job->phase == 1) {
+    jsmn_scan_chunk(job->js, job->len, &job->chunks[job->index]);
+    return NULL;
+  }
+  job->count = JSMN_ERROR_NOMEM;
+  /* Start with about one token per 4 bytes, double as long as needed */
+  job->num_tokens = (jsmnuint_t)(job->len / job->num_chunks / 4) + 16;
+  while (job->count == JSMN_ERROR_NOMEM) {
+    free(job->tokens);
+    job->tokens = malloc(job->num_tokens * sizeof(jsmntok_t));
+    if (job->tokens == NULL) {
+      break;
+    }
+    job->count =
+        jsmn_parse_array_part(&parser, job->js, job->len, job->chunks,
+                              job->num_chunks, job->index, job->tokens,
+                              job->num_tokens);
+    job->num_tokens *= 2;
+  }
+  return NULL;
+}
+
+static int run_phase(struct job *jobs, unsigned int n, int phase) {
+  pthread_t *threads = malloc(n * sizeof(*threads));
+  unsigned int i, started;
+
+  if (threads == NULL) {
+    return 1;
+  }
+  for (i = 0; i < n; i++) {
+    jobs[i].phase = phase;
+  }
+  for (started = 0; started < n; started++) {
+    if (pthread_create(&threads[started], NULL, work, &jobs[started]) != 0) {
+      break;
+    }
+  }
+  for (i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+  return started != n;
+}
+
+/* Returns the number of tokens or an error */
+static jsmnint_t parse(const char *js, size_t len, unsigned int n,
+                       jsmntok_t **tokens) {
+  jsmn_chunk *chunks = calloc(n, sizeof(*chunks));
+  struct job *jobs = calloc(n, sizeof(*jobs));
+  unsigned int i;
+  jsmnuint_t total = 0;
+  jsmnint_t r = JSMN_ERROR_NOMEM;
+
+  *tokens = NULL;
+  if (chunks == NULL || jobs == NULL) {
+    goto out;
+  }
+  for (i = 0; i < n; i++) {
+    chunks[i].start = (jsmnuint_t)(len / n * i);
+    chunks[i].end =
+        i + 1 < n ? (jsmnuint_t)(len / n * (i + 1)) : (jsmnuint_t)len;
+    jobs[i].js = js;
+    jobs[i].len = len;
+    jobs[i].chunks = chunks;
+    jobs[i].num_chunks = n;
+    jobs[i].index = i;
+  }
+  if (run_phase(jobs, n, 1) != 0) {
+    goto out;
+  }
+  r = jsmn_split_array(js, len, chunks, n);
+  if (r < 0) {
+    goto out;
+  }
+  if (run_phase(jobs, n, 2) != 0) {
+    r = JSMN_ERROR_NOMEM;
+    goto out;
+  }
+  for (i = 0; i < n; i++) {
+    if (jobs[i].count < 0) {
+      r = jobs[i].count;
+      goto out;
+    }
+    total += (jsmnuint_t)jobs[i].count;
+  }
+  *tokens = malloc(total * sizeof(jsmntok_t));
+  if (*tokens == NULL) {
+    r = JSMN_ERROR_NOMEM;
+    goto out;
+  }
+  r = 0;
+  for (i = 0; i < n; i++) {
+    r = jsmn_join_array_part(*tokens, total, r, jobs[i].tokens,
+                             jobs[i].count);
+  }
+out:
+  if (jobs != NULL) {
+    for (i = 0; i < n; i++) {
+      free(jobs[i].tokens);
+    }
+  }
+  free(jobs);
+  free(chunks);
+  return r;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  char *js = NULL;
+  size_t len = 0, cap = 0;
+  unsigned int i, n, threads;
+  jsmntok_t *tokens;
+  jsmnint_t r;
+  int bench = argc > 1 && strcmp(argv[1], "-b") == 0;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  threads = (unsigned int)(argc > 1 + bench ? atoi(argv[1 + bench])
+                                            : cpus > 0 ? cpus : 1);
+  if (threads == 0) {
+    fprintf(stderr, "usage: %s [-b] [threads] < data.json\n", argv[0]);
+    return 2;
+  }
+
+  /* Read the whole input */
+  for (;;) {
+    if (len == cap) {
+      char *p;
+      cap = cap == 0 ? 1 << 20 : cap * 2;
+      p = realloc(js, cap);
+      if (p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+      }
+      js = p;
+    }
+    n = (unsigned int)fread(js + len, 1, cap - len, stdin);
+    if (n == 0) {
+      break;
+    }
+    len += n;
+  }
+
+  if (bench) {
+    for (n = 1; n <= threads; n *= 2) {
+      double best = 0;
+      for (i = 0; i < 5; i++) {
+        double t = now();
+        r = parse(js, len, n, &tokens);
+        t = now() - t;
+        free(tokens);
+        if (r < 0) {
+          fprintf(stderr, "error %d\n", (int)r);
+          return 1;
+        }
+        if (i == 0 || t < best) {
+          best = t;
+        }
+      }
+      printf("threads %3u: %8.1f MB/s\n", n, len / best / 1e6);
+    }
+    free(js);
+    return 0;
+  }
+
+  r = parse(js, len, threads, &tokens);
+  if (r < 0) {
+    fprintf(stderr, "error %d\n", (int)r);
+    return 1;
+  }
+  printf("%ld tokens, %ld elements\n", (long)r, (long)tokens[0].size);
+  free(tokens);
+  free(js);
+  return 0;
+}
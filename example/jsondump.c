@@ -20,6 +20,14 @@ static inline void *realloc_it(void *ptrmem, size_t size) {
   return p;
 }
 
+/* Function grow_tokens() lets jsmn_parse_realloc() grow the tokens array with
+ * standard realloc(). On failure the old array stays valid.
+ */
+static void *grow_tokens(void *user, void *ptr, size_t size) {
+  (void)user;
+  return realloc(ptr, size);
+}
+
 /*
  * An example of reading JSON from stdin and printing its content to stdout.
  * The output looks like YAML, but I'm not sure if it's really compatible.
@@ -32,10 +40,10 @@ static int dump(const char *js, jsmntok_t *t, size_t count, int indent) {
     return 0;
   }
   if (t->type == JSMN_PRIMITIVE) {
-    printf("%.*s", t->end - t->start, js + t->start);
+    printf("%.*s", (int)(t->end - t->start), js + t->start);
     return 1;
   } else if (t->type == JSMN_STRING) {
-    printf("'%.*s'", t->end - t->start, js + t->start);
+    printf("'%.*s'", (int)(t->end - t->start), js + t->start);
     return 1;
   } else if (t->type == JSMN_OBJECT) {
     printf("\n");
@@ -78,7 +86,7 @@ int main() {
 
   jsmn_parser p;
   jsmntok_t *tok;
-  size_t tokcount = 2;
+  jsmnuint_t tokcount = 2;
 
   /* Prepare parser */
   jsmn_init(&p);
@@ -113,16 +121,11 @@ int main() {
     strncpy(js + jslen, buf, r);
     jslen = jslen + r;
 
-  again:
-    r = jsmn_parse(&p, js, jslen, tok, tokcount);
+    r = jsmn_parse_realloc(&p, js, jslen, &tok, &tokcount, grow_tokens, NULL);
     if (r < 0) {
       if (r == JSMN_ERROR_NOMEM) {
-        tokcount = tokcount * 2;
-        tok = realloc_it(tok, sizeof(*tok) * tokcount);
-        if (tok == NULL) {
-          return 3;
-        }
-        goto again;
+        fprintf(stderr, "realloc(): errno=%d\n", errno);
+        return 3;
       }
     } else {
       dump(js, tok, p.toknext, 0);
@@ -0,0 +1,221 @@
+#define _POSIX_C_SOURCE 200809L
+#include "../jsmn.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * An example of parsing newline-delimited JSON from stdin on several threads.
+ * The input is split at line boundaries with jsmn_split_lines() and every
+ * worker parses its part with its own parser and token arena, so nothing is
+ * shared between threads. Records of each part are collected separately;
+ * reading the parts one after another gives them in input order.
+ *
+ * Usage: ndjson [threads] < data.json   - parse and report broken records
+ *        ndjson -b [max] < data.json    - throughput for 1, 2, 4 ... threads
+ */
+
+#define BATCH 1024
+
+struct part {
+  const char *js;
+  jsmnuint_t start;
+  jsmnuint_t end;
+  jsmn_record *records; /* all records of the part */
+  size_t num_records;
+  size_t tokens; /* total number of tokens */
+  int error;
+};
+
+static void *parse_part(void *arg) {
+  struct part *part = arg;
+  jsmn_parser parser;
+  jsmn_record batch[BATCH];
+  jsmnuint_t num_tokens = 16 * BATCH;
+  jsmntok_t *tokens = malloc(num_tokens * sizeof(*tokens));
+  size_t cap = 0;
+  int i, r;
+
+  part->records = NULL;
+  part->num_records = 0;
+  part->tokens = 0;
+  part->error = 0;
+
+  jsmn_init(&parser);
+  /* Offsets in records and tokens are relative to the whole input */
+  parser.pos = part->start;
+  while (tokens != NULL) {
+    r = jsmn_parse_lines(&parser, part->js, part->end, tokens, num_tokens,
+                         batch, BATCH);
+    if (r == 0) {
+      break;
+    }
+    if (r == JSMN_ERROR_NOMEM) {
+      /* A single record has more tokens than the arena */
+      jsmntok_t *p = realloc(tokens, 2 * num_tokens * sizeof(*tokens));
+      if (p == NULL) {
+        break;
+      }
+      tokens = p;
+      num_tokens *= 2;
+      continue;
+    }
+    /* Tokens of the batch stay valid until the next call, a real application
+     * would look at them here */
+    if (part->num_records + r > cap) {
+      jsmn_record *p;
+      cap = cap == 0 ? BATCH : cap * 2;
+      p = realloc(part->records, cap * sizeof(*p));
+      if (p == NULL) {
+        break;
+      }
+      part->records = p;
+    }
+    for (i = 0; i < r; i++) {
+      part->tokens += batch[i].count;
+    }
+    memcpy(part->records + part->num_records, batch, r * sizeof(*batch));
+    part->num_records += r;
+  }
+  if (parser.pos < part->end) {
+    fprintf(stderr, "out of memory\n");
+    part->error = 1;
+  }
+  free(tokens);
+  return NULL;
+}
+
+static int run(const char *js, size_t len, struct part *parts,
+               unsigned int num_parts) {
+  pthread_t *threads = malloc(num_parts * sizeof(*threads));
+  jsmnuint_t *bounds = malloc((num_parts + 1) * sizeof(*bounds));
+  unsigned int i, n;
+  int error = 0;
+
+  if (threads == NULL || bounds == NULL) {
+    free(threads);
+    free(bounds);
+    return 1;
+  }
+  jsmn_split_lines(js, len, bounds, num_parts);
+  for (i = 0; i < num_parts; i++) {
+    parts[i].js = js;
+    parts[i].start = bounds[i];
+    parts[i].end = bounds[i + 1];
+    parts[i].records = NULL;
+  }
+  for (n = 0; n < num_parts; n++) {
+    if (pthread_create(&threads[n], NULL, parse_part, &parts[n]) != 0) {
+      fprintf(stderr, "pthread_create() failed\n");
+      error = 1;
+      break;
+    }
+  }
+  for (i = 0; i < n; i++) {
+    pthread_join(threads[i], NULL);
+    error |= parts[i].error;
+  }
+  free(threads);
+  free(bounds);
+  return error;
+}
+
+static void free_parts(struct part *parts, unsigned int num_parts) {
+  unsigned int i;
+  for (i = 0; i < num_parts; i++) {
+    free(parts[i].records);
+  }
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  char *js = NULL;
+  size_t len = 0, cap = 0;
+  unsigned int i, n, threads;
+  size_t j, records = 0, tokens = 0, broken = 0;
+  struct part *parts;
+  int bench = argc > 1 && strcmp(argv[1], "-b") == 0;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  threads = (unsigned int)(argc > 1 + bench ? atoi(argv[1 + bench])
+                                            : cpus > 0 ? cpus : 1);
+  if (threads == 0) {
+    fprintf(stderr, "usage: %s [-b] [threads] < data.json\n", argv[0]);
+    return 2;
+  }
+
+  /* Read the whole input */
+  for (;;) {
+    if (len == cap) {
+      char *p;
+      cap = cap == 0 ? 1 << 20 : cap * 2;
+      p = realloc(js, cap);
+      if (p == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+      }
+      js = p;
+    }
+    n = (unsigned int)fread(js + len, 1, cap - len, stdin);
+    if (n == 0) {
+      break;
+    }
+    len += n;
+  }
+
+  parts = calloc(threads, sizeof(*parts));
+  if (parts == NULL) {
+    return 1;
+  }
+
+  if (bench) {
+    for (n = 1; n <= threads; n *= 2) {
+      double best = 0;
+      for (i = 0; i < 5; i++) {
+        double t = now();
+        if (run(js, len, parts, n) != 0) {
+          return 1;
+        }
+        t = now() - t;
+        if (i == 0 || t < best) {
+          best = t;
+        }
+        free_parts(parts, n);
+      }
+      printf("threads %3u: %8.1f MB/s\n", n, len / best / 1e6);
+    }
+    free(parts);
+    free(js);
+    return 0;
+  }
+
+  if (run(js, len, parts, threads) != 0) {
+    return 1;
+  }
+  for (i = 0; i < threads; i++) {
+    for (j = 0; j < parts[i].num_records; j++) {
+      jsmn_record *rec = &parts[i].records[j];
+      if (rec->error != 0) {
+        printf("broken record at %ld..%ld: %d\n", (long)rec->start,
+               (long)rec->end, rec->error);
+        broken++;
+      }
+    }
+    records += parts[i].num_records;
+    tokens += parts[i].tokens;
+  }
+  printf("%lu records, %lu tokens, %lu broken\n", (unsigned long)records,
+         (unsigned long)tokens, (unsigned long)broken);
+  free_parts(parts, threads);
+  free(parts);
+  free(js);
+  return broken != 0;
+}
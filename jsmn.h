@@ -25,6 +25,27 @@
 #define JSMN_H
 
 #include <stddef.h>
+#ifndef JSMN_HEADER
+#include <float.h>
+#endif
+
+#if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 199901L) ||             \
+    defined(__cplusplus) || defined(_MSC_VER)
+#include <stdint.h>
+#define JSMN_HAS_INT64
+#endif
+
+#ifdef JSMN_SIMD
+#if defined(__AVX2__)
+#define JSMN_SIMD_AVX2
+#define JSMN_SIMD_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSMN_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -57,33 +78,109 @@ enum jsmnerr {
   /* Invalid character inside JSON string */
   JSMN_ERROR_INVAL = -2,
   /* The string is not a full JSON packet, more bytes expected */
-  JSMN_ERROR_PART = -3
+  JSMN_ERROR_PART = -3,
+  /* Objects or arrays are nested deeper than JSMN_MAX_DEPTH */
+  JSMN_ERROR_DEPTH = -4,
+  /* A number does not fit into the requested type, or an object or array has
+   * more children than the size of a JSMN_COMPACT token can count */
+  JSMN_ERROR_RANGE = -5,
+  /* A callback of jsmn_parse_events() returned non-zero */
+  JSMN_ERROR_STOP = -6
 };
 
+/**
+ * Offsets in the JSON string, token indices and counts. With JSMN_LARGE they
+ * are as wide as a pointer, so strings may be larger than 2 GiB.
+ */
+#ifdef JSMN_LARGE
+typedef ptrdiff_t jsmnint_t;
+typedef size_t jsmnuint_t;
+#else
+typedef int jsmnint_t;
+typedef unsigned int jsmnuint_t;
+#endif
+
 /**
  * JSON token description.
  * type		type (object, array, string etc.)
  * start	start position in JSON data string
  * end		end position in JSON data string
+ * next		index of the first token after this value and all its contents
+ *
+ * With JSMN_COMPACT type and size share one 32-bit word, which makes tokens
+ * 25% smaller but limits the number of children to JSMN_MAX_SIZE (2^29 - 1);
+ * parsing a larger object or array fails with JSMN_ERROR_RANGE.
  */
+#ifdef JSMN_COMPACT
+#define JSMN_MAX_SIZE 0x1FFFFFFF
+#endif
+
 typedef struct jsmntok {
+#ifdef JSMN_COMPACT
+  unsigned int type : 3; /* jsmntype_t */
+  unsigned int size : 29;
+  jsmnint_t start;
+  jsmnint_t end;
+#else
   jsmntype_t type;
-  int start;
-  int end;
-  int size;
+  jsmnint_t start;
+  jsmnint_t end;
+  jsmnint_t size;
+#endif
 #ifdef JSMN_PARENT_LINKS
-  int parent;
+  jsmnint_t parent;
+#endif
+#ifdef JSMN_SKIP_LINKS
+  jsmnint_t next;
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+  int escaped; /* string contains escape sequences */
 #endif
 } jsmntok_t;
 
+#ifdef JSMN_STATS
+/**
+ * Counters of the work done since jsmn_init(), to tell what makes a document
+ * slow to parse. Objects and arrays count as found even without tokens, the
+ * nesting depth is tracked only with tokens.
+ */
+typedef struct jsmn_stats {
+  size_t bytes;           /* bytes scanned by all calls */
+  size_t rescanned;       /* bytes scanned again by a later call */
+  size_t tokens[5];       /* values found by type, e.g. tokens[JSMN_STRING] */
+  unsigned int max_depth; /* deepest nesting of objects and arrays */
+  size_t scan_steps;      /* tokens visited looking back for the parent */
+  size_t restarts;        /* calls continuing after JSMN_ERROR_PART */
+  size_t scanned_end;     /* end of the input scanned so far */
+  int partial;            /* the last call returned JSMN_ERROR_PART */
+} jsmn_stats;
+#endif
+
 /**
  * JSON parser. Contains an array of token blocks available. Also stores
- * the string being parsed now and current position in that string.
+ * the string being parsed now and current position in that string. The
+ * fields after toksuper are used in every build, to continue after
+ * JSMN_ERROR_PART and by jsmn_parse_next_element(); the layout differs from
+ * older versions, so initialize it only with jsmn_init().
  */
 typedef struct jsmn_parser {
-  unsigned int pos;     /* offset in the JSON string */
-  unsigned int toknext; /* next token to allocate */
-  int toksuper;         /* superior token node, e.g. parent object or array */
+  jsmnuint_t pos;     /* offset in the JSON string */
+  jsmnuint_t toknext; /* next token to allocate */
+  jsmnint_t toksuper; /* superior token node, e.g. parent object or array */
+  unsigned int depth; /* number of currently open objects/arrays */
+  jsmnint_t tokstart; /* start of a value cut off by end of input */
+  int escape;   /* progress in an escape sequence cut off by end of input */
+  int element;  /* progress through the array read by jsmn_parse_next_element,
+                   type of the last value of jsmn_parse_events */
+#ifdef JSMN_ESCAPE_FLAGS
+  int escaped; /* the string being parsed has escape sequences */
+#endif
+#ifdef JSMN_MAX_DEPTH
+  jsmnint_t stack[JSMN_MAX_DEPTH]; /* token indices of open objects/arrays */
+#endif
+#ifdef JSMN_STATS
+  jsmn_stats stats;
+#endif
 } jsmn_parser;
 
 /**
@@ -96,10 +193,363 @@ JSMN_API void jsmn_init(jsmn_parser *parser);
  * describing
  * a single JSON object.
  */
-JSMN_API int jsmn_parse(jsmn_parser *parser, const char *js, const size_t len,
-                        jsmntok_t *tokens, const unsigned int num_tokens);
+JSMN_API jsmnint_t jsmn_parse(jsmn_parser *parser, const char *js,
+                              const size_t len, jsmntok_t *tokens,
+                              const jsmnuint_t num_tokens);
+
+/**
+ * Finds offsets of structural characters of a JSON data string: brackets,
+ * colons and commas outside of strings, opening quotes of strings and first
+ * characters of primitives. Returns the number of offsets found. Passing NULL
+ * instead of the indices array only counts them.
+ */
+JSMN_API jsmnint_t jsmn_structurals(const char *js, const size_t len,
+                                    jsmnuint_t *indices,
+                                    const jsmnuint_t num_indices);
+
+/**
+ * Counts tokens jsmn_parse() creates for a valid JSON string and measures the
+ * deepest nesting of objects and arrays. Only the structure is checked:
+ * returns JSMN_ERROR_INVAL for a closing bracket without an opening one and
+ * JSMN_ERROR_PART for an unclosed string, object or array.
+ */
+JSMN_API jsmnint_t jsmn_measure(const char *js, const size_t len,
+                                unsigned int *max_depth);
+
+/**
+ * Finds the value a JSON Pointer (RFC 6901) such as "/meta/trace_id" refers
+ * to, parsing only as much of the JSON string as needed to reach it. Returns
+ * 1 and fills the token, 0 if there is no such value, or an error.
+ */
+JSMN_API int jsmn_find_path(const char *js, const size_t len,
+                            const char *path, jsmntok_t *token);
+
+/**
+ * Hash table over the keys of one object, for looking up members in constant
+ * expected time. The slots are provided by the caller.
+ */
+typedef struct jsmn_index {
+  jsmnint_t object;     /* token index of the object */
+  jsmnint_t *slots;     /* token indices of keys, -1 for empty slots */
+  jsmnuint_t num_slots; /* a power of two larger than the object size */
+} jsmn_index;
+
+/**
+ * Builds an index over the keys of the object at the given token index. If a
+ * key is repeated, the first one wins.
+ */
+JSMN_API int jsmn_index_init(jsmn_index *index, const char *js,
+                             const jsmntok_t *tokens, const jsmnint_t object,
+                             jsmnint_t *slots, const jsmnuint_t num_slots);
+
+/**
+ * Returns the token index of the value of the given key, or -1 if the
+ * indexed object has no such key.
+ */
+JSMN_API jsmnint_t jsmn_index_find(const jsmn_index *index, const char *js,
+                                   const jsmntok_t *tokens, const char *key,
+                                   const size_t key_len);
+
+/**
+ * Convert a number token, checking it against the JSON number grammar.
+ * Returns 0, JSMN_ERROR_INVAL if the token is not a number (for integers also
+ * if it has a fraction or an exponent), or JSMN_ERROR_RANGE if the number
+ * doesn't fit.
+ */
+JSMN_API int jsmn_tok_to_double(const char *js, const jsmntok_t *tok,
+                                double *value);
+#ifdef JSMN_HAS_INT64
+JSMN_API int jsmn_tok_to_int64(const char *js, const jsmntok_t *tok,
+                               int64_t *value);
+JSMN_API int jsmn_tok_to_uint64(const char *js, const jsmntok_t *tok,
+                                uint64_t *value);
+#endif
+
+/**
+ * Convert all elements of an array of numbers at the given token index into
+ * a contiguous buffer. Returns the number of elements.
+ */
+JSMN_API jsmnint_t jsmn_array_to_double(const char *js,
+                                        const jsmntok_t *tokens,
+                                        const jsmnint_t array, double *values,
+                                        const jsmnuint_t num_values);
+#ifdef JSMN_HAS_INT64
+JSMN_API jsmnint_t jsmn_array_to_int64(const char *js,
+                                       const jsmntok_t *tokens,
+                                       const jsmnint_t array, int64_t *values,
+                                       const jsmnuint_t num_values);
+#endif
+
+/**
+ * Decode escape sequences of a string token into a buffer, which may be the
+ * token itself (js + tok->start). Returns the length of the decoded string.
+ */
+JSMN_API jsmnint_t jsmn_unescape(const char *js, const jsmntok_t *tok,
+                                 char *out, const size_t out_len);
+
+/**
+ * Run JSON parser over the structural offsets returned by jsmn_structurals()
+ * for the same string, skipping whitespace between them. Tokens and return
+ * values are the same as with jsmn_parse().
+ */
+JSMN_API jsmnint_t jsmn_parse_structurals(jsmn_parser *parser,
+                                          const char *js, const size_t len,
+                                          const jsmnuint_t *indices,
+                                          const jsmnuint_t num_indices,
+                                          jsmntok_t *tokens,
+                                          const jsmnuint_t num_tokens);
+
+/**
+ * Run JSON parser like jsmn_parse(), but instead of returning
+ * JSMN_ERROR_NOMEM grow the tokens array with a realloc-like function and
+ * carry on. The tokens array (which may start as NULL) and its size are
+ * updated in place.
+ */
+JSMN_API jsmnint_t jsmn_parse_realloc(jsmn_parser *parser, const char *js,
+                                      const size_t len, jsmntok_t **tokens,
+                                      jsmnuint_t *num_tokens,
+                                      void *(*grow)(void *user, void *ptr,
+                                                    size_t size),
+                                      void *user);
+
+/**
+ * Parse the next element of a top-level JSON array. Tokens of the element are
+ * stored from the beginning of the tokens array, replacing the previous
+ * element. Returns the number of tokens of the element or 0 after the end of
+ * the array. The tokens array can't be NULL.
+ */
+JSMN_API jsmnint_t jsmn_parse_next_element(jsmn_parser *parser,
+                                           const char *js, const size_t len,
+                                           jsmntok_t *tokens,
+                                           const jsmnuint_t num_tokens);
+
+/**
+ * A line of newline-delimited JSON parsed by jsmn_parse_lines().
+ */
+typedef struct jsmn_record {
+  jsmnint_t token; /* index of the first token */
+  jsmnint_t count; /* number of tokens, 0 if the record is broken */
+  jsmnint_t start; /* byte range of the line, without the newline */
+  jsmnint_t end;
+  int error; /* 0 or the error jsmn_parse() returned for the line */
+} jsmn_record;
+
+/**
+ * Parse newline-delimited JSON, one record per non-blank line. Tokens of all
+ * records are stored one after another from the beginning of the tokens
+ * array; links between tokens are relative to the first token of the record.
+ * Returns the number of records, 0 after the end of data; the next call
+ * continues with the following line. Neither array can be NULL.
+ */
+JSMN_API int jsmn_parse_lines(jsmn_parser *parser, const char *js,
+                              const size_t len, jsmntok_t *tokens,
+                              const jsmnuint_t num_tokens,
+                              jsmn_record *records,
+                              const unsigned int num_records);
+
+/**
+ * Split newline-delimited JSON into parts of about the same size that start
+ * at the beginning of a line, e.g. to parse them in parallel. Fills num_parts
+ * + 1 offsets, part i is bounds[i] .. bounds[i + 1] - 1.
+ */
+JSMN_API void jsmn_split_lines(const char *js, const size_t len,
+                               jsmnuint_t *bounds,
+                               const unsigned int num_parts);
+
+/**
+ * A chunk of a JSON string that is one large array, for parsing it in
+ * parallel. The caller sets the byte range, the first chunk starting at 0.
+ */
+typedef struct jsmn_chunk {
+  jsmnuint_t start; /* byte range of the chunk */
+  jsmnuint_t end;
+  int quotes;         /* 1 if the chunk has an odd number of unescaped quotes */
+  jsmnint_t depth[2]; /* change of nesting depth if the chunk starts outside
+                         [0] or inside [1] a string */
+  jsmnint_t low[2];   /* lowest depth of a comma, relative like depth */
+  jsmnuint_t comma[2]; /* first comma at that depth, (jsmnuint_t)-1 if none */
+  jsmnuint_t split;    /* start of the part of the array parsed for the chunk */
+} jsmn_chunk;
+
+/**
+ * Scan a chunk without knowing what comes before it. Chunks can be scanned
+ * in parallel.
+ */
+JSMN_API void jsmn_scan_chunk(const char *js, const size_t len,
+                              jsmn_chunk *chunk);
+
+/**
+ * Split the top-level array between its elements, one part per scanned
+ * chunk. Parts of chunks within a single element are empty.
+ */
+JSMN_API int jsmn_split_array(const char *js, const size_t len,
+                              jsmn_chunk *chunks,
+                              const unsigned int num_chunks);
+
+/**
+ * Parse the elements of the top-level array in one part. Parts can be parsed
+ * in parallel, each into its own tokens. The first token of every part is the
+ * top-level array. Returns the number of tokens.
+ */
+JSMN_API jsmnint_t jsmn_parse_array_part(jsmn_parser *parser, const char *js,
+                                         const size_t len,
+                                         const jsmn_chunk *chunks,
+                                         const unsigned int num_chunks,
+                                         const unsigned int part,
+                                         jsmntok_t *tokens,
+                                         const jsmnuint_t num_tokens);
+
+/**
+ * Append the tokens of a part to the tokens of the whole array, which hold
+ * count tokens so far. Parts must be joined in order, the result is the same
+ * as with jsmn_parse(). Returns the new number of tokens.
+ */
+JSMN_API jsmnint_t jsmn_join_array_part(jsmntok_t *tokens,
+                                        const jsmnuint_t num_tokens,
+                                        const jsmnint_t count,
+                                        const jsmntok_t *part,
+                                        const jsmnint_t part_count);
+
+#ifdef JSMN_MAX_DEPTH
+/**
+ * Callbacks of jsmn_parse_events(). Offsets are the same as the start and end
+ * of the token jsmn_parse() would create. Any of them may be NULL.
+ */
+typedef struct jsmn_callbacks {
+  /* object or array */
+  int (*begin)(void *user, jsmntype_t type, jsmnint_t start);
+  int (*end)(void *user, jsmntype_t type, jsmnint_t end);
+  int (*key)(void *user, jsmnint_t start, jsmnint_t end);
+  int (*string)(void *user, jsmnint_t start, jsmnint_t end);
+  int (*primitive)(void *user, jsmnint_t start, jsmnint_t end);
+} jsmn_callbacks;
+
+/**
+ * Run JSON parser without a tokens array, calling back for every value
+ * instead. Returns the number of tokens jsmn_parse() would create, or the
+ * same error. A callback returning non-zero stops the parser with
+ * JSMN_ERROR_STOP.
+ */
+JSMN_API jsmnint_t jsmn_parse_events(jsmn_parser *parser, const char *js,
+                                     const size_t len, const jsmn_callbacks *cb,
+                                     void *user);
+#endif
+
+/**
+ * Writer appending JSON text to a buffer provided by the caller. Without a
+ * grow function the buffer has a fixed size, otherwise it is grown with the
+ * realloc-like function when full. The first error sticks: nothing more is
+ * written and every later call returns it.
+ */
+typedef struct jsmn_writer {
+  char *buf;
+  size_t len;  /* bytes written, the text is not NUL-terminated */
+  size_t size; /* size of the buffer */
+  void *(*grow)(void *user, void *ptr, size_t size);
+  void *user;
+  int error;          /* 0 or the first error */
+  int comma;          /* a comma is due before the next key or value */
+  unsigned int depth; /* open objects and arrays */
+} jsmn_writer;
+
+/**
+ * Start writing into a buffer, which may be NULL if grow is not.
+ */
+JSMN_API void jsmn_writer_init(jsmn_writer *writer, char *buf,
+                               const size_t size,
+                               void *(*grow)(void *user, void *ptr,
+                                             size_t size),
+                               void *user);
+
+/**
+ * Write the brackets of objects and arrays. Only the nesting is counted, it
+ * is up to the caller to close what was opened and to alternate keys and
+ * values in objects. Return 0 or an error, like all writer functions.
+ */
+JSMN_API int jsmn_write_begin_object(jsmn_writer *writer);
+JSMN_API int jsmn_write_end_object(jsmn_writer *writer);
+JSMN_API int jsmn_write_begin_array(jsmn_writer *writer);
+JSMN_API int jsmn_write_end_array(jsmn_writer *writer);
+
+/**
+ * Write a key or a string value, escaping quotes, backslashes and control
+ * characters. Other bytes, UTF-8 included, are copied as they are.
+ */
+JSMN_API int jsmn_write_key(jsmn_writer *writer, const char *key,
+                            const size_t len);
+JSMN_API int jsmn_write_string(jsmn_writer *writer, const char *str,
+                               const size_t len);
+
+/**
+ * Write a number with the fewest digits that read back as the same double.
+ * NaN and infinities have no JSON form and are JSMN_ERROR_INVAL.
+ */
+JSMN_API int jsmn_write_double(jsmn_writer *writer, const double value);
+#ifdef JSMN_HAS_INT64
+JSMN_API int jsmn_write_int64(jsmn_writer *writer, const int64_t value);
+JSMN_API int jsmn_write_uint64(jsmn_writer *writer, const uint64_t value);
+#endif
+JSMN_API int jsmn_write_bool(jsmn_writer *writer, const int value);
+JSMN_API int jsmn_write_null(jsmn_writer *writer);
+
+/**
+ * Write a value that already is JSON text, such as a token of a parsed
+ * string, as it is.
+ */
+JSMN_API int jsmn_write_raw(jsmn_writer *writer, const char *js,
+                            const size_t len);
+
+/**
+ * Edits of a parsed document for jsmn_write_patched().
+ */
+typedef enum {
+  JSMN_PATCH_REPLACE = 0, /* replace the token with value */
+  JSMN_PATCH_DELETE = 1,  /* delete the member whose key is the token, or the
+                             array element */
+  JSMN_PATCH_INSERT = 2   /* append key and value to the object, or value to
+                             the array */
+} jsmnpatch_t;
+
+typedef struct jsmn_patch {
+  jsmnpatch_t op;
+  jsmnint_t token;   /* index of the token edited */
+  const char *key;   /* key of an inserted member, escaped when written */
+  size_t key_len;
+  const char *value; /* JSON text written as it is */
+  size_t value_len;
+  jsmnint_t from; /* set by jsmn_write_patched(): byte range replaced */
+  jsmnint_t to;
+} jsmn_patch;
+
+/**
+ * Write the value of the first token with the edits applied. Untouched parts
+ * of the JSON string are copied as they are, only edited values and the
+ * commas around them are written anew. Edits may come in any order, edits
+ * of a value and of something inside it are JSMN_ERROR_INVAL.
+ */
+JSMN_API int jsmn_write_patched(jsmn_writer *writer, const char *js,
+                                const jsmntok_t *tokens,
+                                const jsmnint_t num_tokens,
+                                jsmn_patch *patches,
+                                const unsigned int num_patches);
 
 #ifndef JSMN_HEADER
+/* Hot helpers shared by several parsing loops must not become calls */
+#if defined(__GNUC__)
+#define JSMN_INLINE static __inline__ __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define JSMN_INLINE static __forceinline
+#else
+#define JSMN_INLINE static
+#endif
+
+/* Instrumentation counters, nothing is left of them without JSMN_STATS */
+#ifdef JSMN_STATS
+#define JSMN_STATS_ADD(parser, counter, n) ((parser)->stats.counter += (n))
+#else
+#define JSMN_STATS_ADD(parser, counter, n) ((void)0)
+#endif
+
 /**
  * Allocates a fresh unused token from the token pool.
  */
@@ -114,15 +564,35 @@ static jsmntok_t *jsmn_alloc_token(jsmn_parser *parser, jsmntok_t *tokens,
   tok->size = 0;
 #ifdef JSMN_PARENT_LINKS
   tok->parent = -1;
+#endif
+#ifdef JSMN_SKIP_LINKS
+  tok->next = -1;
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+  tok->escaped = 0;
 #endif
   return tok;
 }
 
+/**
+ * Counts one more child of a token. Returns JSMN_ERROR_RANGE if its size has
+ * no room for it.
+ */
+JSMN_INLINE int jsmn_add_child(jsmntok_t *token) {
+#ifdef JSMN_COMPACT
+  if (token->size == JSMN_MAX_SIZE) {
+    return JSMN_ERROR_RANGE;
+  }
+#endif
+  token->size++;
+  return 0;
+}
+
 /**
  * Fills token type and boundaries.
  */
 static void jsmn_fill_token(jsmntok_t *token, const jsmntype_t type,
-                            const int start, const int end) {
+                            const jsmnint_t start, const jsmnint_t end) {
   token->type = type;
   token->start = start;
   token->end = end;
@@ -132,16 +602,19 @@ static void jsmn_fill_token(jsmntok_t *token, const jsmntype_t type,
 /**
  * Fills next available token with JSON primitive.
  */
-static int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
-                                const size_t len, jsmntok_t *tokens,
-                                const size_t num_tokens) {
+JSMN_INLINE int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
+                                     const size_t len, jsmntok_t *tokens,
+                                     const size_t num_tokens) {
   jsmntok_t *token;
-  int start;
+  jsmnuint_t pos = parser->pos;
+  jsmnint_t start = parser->tokstart;
 
-  start = parser->pos;
+  if (start == -1) {
+    start = (jsmnint_t)pos;
+  }
 
-  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
-    switch (js[parser->pos]) {
+  for (; pos < len && js[pos] != '\0'; pos++) {
+    switch (js[pos]) {
 #ifndef JSMN_STRICT
     /* In strict mode primitive must be followed by "," or "}" or "]" */
     case ':':
@@ -158,73 +631,126 @@ static int jsmn_parse_primitive(jsmn_parser *parser, const char *js,
                    /* to quiet a warning from gcc*/
       break;
     }
-    if (js[parser->pos] < 32 || js[parser->pos] >= 127) {
+    if (js[pos] < 32 || js[pos] >= 127) {
       parser->pos = start;
+      parser->tokstart = -1;
       return JSMN_ERROR_INVAL;
     }
   }
 #ifdef JSMN_STRICT
   /* In strict mode primitive must be followed by a comma/object/array */
-  parser->pos = start;
+  parser->pos = pos;
+  parser->tokstart = start;
   return JSMN_ERROR_PART;
 #endif
 
 found:
+  parser->pos = pos;
   if (tokens == NULL) {
     parser->pos--;
     return 0;
   }
   token = jsmn_alloc_token(parser, tokens, num_tokens);
   if (token == NULL) {
-    parser->pos = start;
+    /* Resume right at the terminating character */
+    parser->tokstart = start;
     return JSMN_ERROR_NOMEM;
   }
-  jsmn_fill_token(token, JSMN_PRIMITIVE, start, parser->pos);
+  jsmn_fill_token(token, JSMN_PRIMITIVE, start, (jsmnint_t)pos);
 #ifdef JSMN_PARENT_LINKS
   token->parent = parser->toksuper;
+#endif
+#ifdef JSMN_SKIP_LINKS
+  token->next = parser->toknext;
 #endif
   parser->pos--;
   return 0;
 }
 
 /**
- * Fills next token with JSON string.
+ * Returns the index of the lowest set bit of a non-zero mask.
  */
-static int jsmn_parse_string(jsmn_parser *parser, const char *js,
-                             const size_t len, jsmntok_t *tokens,
-                             const size_t num_tokens) {
-  jsmntok_t *token;
-
-  int start = parser->pos;
-
-  parser->pos++;
+static unsigned int jsmn_ctz(unsigned long mask) {
+#if defined(__GNUC__)
+  return (unsigned int)__builtin_ctzl(mask);
+#else
+  unsigned int n = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    n++;
+  }
+  return n;
+#endif
+}
 
-  /* Skip starting quote */
-  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
-    char c = js[parser->pos];
+#ifdef JSMN_SIMD_SSE2
+/**
+ * Returns the number of set bits of a mask.
+ */
+static unsigned int jsmn_popcount(unsigned long mask) {
+#if defined(__GNUC__)
+  return (unsigned int)__builtin_popcountl(mask);
+#else
+  unsigned int n = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    n++;
+  }
+  return n;
+#endif
+}
 
-    /* Quote: end of string */
-    if (c == '\"') {
-      if (tokens == NULL) {
-        return 0;
-      }
-      token = jsmn_alloc_token(parser, tokens, num_tokens);
-      if (token == NULL) {
-        parser->pos = start;
-        return JSMN_ERROR_NOMEM;
-      }
-      jsmn_fill_token(token, JSMN_STRING, start + 1, parser->pos);
-#ifdef JSMN_PARENT_LINKS
-      token->parent = parser->toksuper;
+/**
+ * Skips string characters that need no attention and returns the offset of
+ * the first quote, backslash or NUL at or after pos. Only whole vectors are
+ * examined, so the returned offset may point at an ordinary character when
+ * less than a vector of input is left.
+ */
+static jsmnuint_t jsmn_skip_string_chars(const char *js, jsmnuint_t pos,
+                                         const size_t len) {
+#if defined(JSMN_SIMD_AVX2)
+  const __m256i quote = _mm256_set1_epi8('\"');
+  const __m256i bslash = _mm256_set1_epi8('\\');
+  const __m256i zero = _mm256_setzero_si256();
+  for (; pos + 32 <= len; pos += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(js + pos));
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                        _mm256_cmpeq_epi8(v, bslash)),
+        _mm256_cmpeq_epi8(v, zero)));
+    if (mask != 0) {
+      return pos + jsmn_ctz(mask);
+    }
+  }
 #endif
-      return 0;
+  {
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i zero = _mm_setzero_si128();
+    for (; pos + 16 <= len; pos += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(js + pos));
+      unsigned int mask = (unsigned int)_mm_movemask_epi8(
+          _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                    _mm_cmpeq_epi8(v, bslash)),
+                       _mm_cmpeq_epi8(v, zero)));
+      if (mask != 0) {
+        return pos + jsmn_ctz(mask);
+      }
     }
+  }
+  return pos;
+}
+#endif /* JSMN_SIMD_SSE2 */
 
-    /* Backslash: Quoted symbol expected */
-    if (c == '\\' && parser->pos + 1 < len) {
-      int i;
-      parser->pos++;
-      switch (js[parser->pos]) {
+/**
+ * Validates an escape sequence, parser->escape tells how much of it has been
+ * read already. Stops at the last character of the sequence.
+ */
+static int jsmn_parse_escape(jsmn_parser *parser, const char *js,
+                             const size_t len) {
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+    char c = js[parser->pos];
+    if (parser->escape == 1) {
+      switch (c) {
       /* Allowed escaped symbols */
       case '\"':
       case '/':
@@ -234,232 +760,3884 @@ static int jsmn_parse_string(jsmn_parser *parser, const char *js,
       case 'r':
       case 'n':
       case 't':
-        break;
-      /* Allows escaped symbol \uXXXX */
+        parser->escape = 0;
+        return 0;
+      /* Allows escaped symbol \uXXXX, escape counts hex digits from 2 to 5 */
       case 'u':
-        parser->pos++;
-        for (i = 0; i < 4 && parser->pos < len && js[parser->pos] != '\0';
-             i++) {
-          /* If it isn't a hex character we have an error */
-          if (!((js[parser->pos] >= 48 && js[parser->pos] <= 57) ||   /* 0-9 */
-                (js[parser->pos] >= 65 && js[parser->pos] <= 70) ||   /* A-F */
-                (js[parser->pos] >= 97 && js[parser->pos] <= 102))) { /* a-f */
-            parser->pos = start;
-            return JSMN_ERROR_INVAL;
-          }
-          parser->pos++;
-        }
-        parser->pos--;
+        parser->escape = 2;
         break;
       /* Unexpected symbol */
       default:
-        parser->pos = start;
         return JSMN_ERROR_INVAL;
       }
+    } else {
+      /* If it isn't a hex character we have an error */
+      if (!((c >= 48 && c <= 57) ||   /* 0-9 */
+            (c >= 65 && c <= 70) ||   /* A-F */
+            (c >= 97 && c <= 102))) { /* a-f */
+        return JSMN_ERROR_INVAL;
+      }
+      if (parser->escape++ == 5) {
+        parser->escape = 0;
+        return 0;
+      }
     }
   }
-  parser->pos = start;
+  /* NUL can't be escaped */
+  if (parser->escape == 1 && parser->pos < len) {
+    return JSMN_ERROR_INVAL;
+  }
   return JSMN_ERROR_PART;
 }
 
 /**
- * Parse JSON string and fill tokens.
+ * Fills next token with JSON string.
  */
-JSMN_API int jsmn_parse(jsmn_parser *parser, const char *js, const size_t len,
-                        jsmntok_t *tokens, const unsigned int num_tokens) {
-  int r;
-  int i;
+JSMN_INLINE int jsmn_parse_string(jsmn_parser *parser, const char *js,
+                                  const size_t len, jsmntok_t *tokens,
+                                  const size_t num_tokens) {
   jsmntok_t *token;
-  int count = parser->toknext;
+  int r;
+  jsmnuint_t pos;
 
-  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+  jsmnint_t start = parser->tokstart;
+
+  if (start == -1) {
+    /* Skip starting quote */
+    start = (jsmnint_t)parser->pos++;
+#ifdef JSMN_ESCAPE_FLAGS
+    parser->escaped = 0;
+#endif
+  } else if (parser->escape != 0) {
+    /* Finish the escape sequence the previous call stopped in */
+    r = jsmn_parse_escape(parser, js, len);
+    if (r == JSMN_ERROR_PART) {
+      return r;
+    }
+    if (r < 0) {
+      goto invalid;
+    }
+    parser->pos++;
+  }
+
+  for (pos = parser->pos; pos < len && js[pos] != '\0'; pos++) {
     char c;
-    jsmntype_t type;
 
-    c = js[parser->pos];
-    switch (c) {
-    case '{':
-    case '[':
-      count++;
+#ifdef JSMN_SIMD_SSE2
+    pos = jsmn_skip_string_chars(js, pos, len);
+    if (pos >= len || js[pos] == '\0') {
+      break;
+    }
+#endif
+    c = js[pos];
+
+    /* Quote: end of string */
+    if (c == '\"') {
+      parser->pos = pos;
       if (tokens == NULL) {
-        break;
+        return 0;
       }
       token = jsmn_alloc_token(parser, tokens, num_tokens);
       if (token == NULL) {
+        /* Resume right at the closing quote */
+        parser->tokstart = start;
         return JSMN_ERROR_NOMEM;
       }
-      if (parser->toksuper != -1) {
-        jsmntok_t *t = &tokens[parser->toksuper];
-#ifdef JSMN_STRICT
-        /* In strict mode an object or array can't become a key */
-        if (t->type == JSMN_OBJECT) {
-          return JSMN_ERROR_INVAL;
-        }
-#endif
-        t->size++;
+      jsmn_fill_token(token, JSMN_STRING, start + 1, (jsmnint_t)pos);
 #ifdef JSMN_PARENT_LINKS
-        token->parent = parser->toksuper;
+      token->parent = parser->toksuper;
 #endif
-      }
-      token->type = (c == '{' ? JSMN_OBJECT : JSMN_ARRAY);
-      token->start = parser->pos;
-      parser->toksuper = parser->toknext - 1;
-      break;
-    case '}':
-    case ']':
-      if (tokens == NULL) {
+#ifdef JSMN_SKIP_LINKS
+      token->next = parser->toknext;
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+      token->escaped = parser->escaped;
+#endif
+      return 0;
+    }
+
+    /* Backslash: Quoted symbol expected */
+    if (c == '\\') {
+#ifdef JSMN_ESCAPE_FLAGS
+      parser->escaped = 1;
+#endif
+      parser->pos = pos + 1;
+      parser->escape = 1;
+      r = jsmn_parse_escape(parser, js, len);
+      pos = parser->pos;
+      if (r == JSMN_ERROR_PART) {
         break;
       }
-      type = (c == '}' ? JSMN_OBJECT : JSMN_ARRAY);
-#ifdef JSMN_PARENT_LINKS
-      if (parser->toknext < 1) {
-        return JSMN_ERROR_INVAL;
-      }
-      token = &tokens[parser->toknext - 1];
-      for (;;) {
-        if (token->start != -1 && token->end == -1) {
-          if (token->type != type) {
-            return JSMN_ERROR_INVAL;
-          }
-          token->end = parser->pos + 1;
-          parser->toksuper = token->parent;
-          break;
-        }
-        if (token->parent == -1) {
-          if (token->type != type || parser->toksuper == -1) {
-            return JSMN_ERROR_INVAL;
-          }
-          break;
-        }
-        token = &tokens[token->parent];
+      if (r < 0) {
+        goto invalid;
       }
-#else
-      for (i = parser->toknext - 1; i >= 0; i--) {
-        token = &tokens[i];
-        if (token->start != -1 && token->end == -1) {
-          if (token->type != type) {
-            return JSMN_ERROR_INVAL;
-          }
-          parser->toksuper = -1;
-          token->end = parser->pos + 1;
-          break;
-        }
-      }
-      /* Error if unmatched closing bracket */
-      if (i == -1) {
+    }
+  }
+  /* Keep the scanning state, the next call continues from here */
+  parser->pos = pos;
+  parser->tokstart = start;
+  return JSMN_ERROR_PART;
+
+invalid:
+  parser->pos = start;
+  parser->tokstart = -1;
+  parser->escape = 0;
+  return JSMN_ERROR_INVAL;
+}
+
+/**
+ * Finishes a string or primitive cut off by the end of input or by running out
+ * of tokens during the previous call.
+ */
+static int jsmn_parse_resume(jsmn_parser *parser, const char *js,
+                             const size_t len, jsmntok_t *tokens,
+                             const size_t num_tokens, jsmnint_t *count) {
+  int r;
+  const int string = js[parser->tokstart] == '\"';
+  if (string) {
+    r = jsmn_parse_string(parser, js, len, tokens, num_tokens);
+  } else {
+    r = jsmn_parse_primitive(parser, js, len, tokens, num_tokens);
+  }
+  if (r < 0) {
+    return r;
+  }
+  JSMN_STATS_ADD(parser, tokens[string ? JSMN_STRING : JSMN_PRIMITIVE], 1);
+  parser->tokstart = -1;
+  (*count)++;
+  if (parser->toksuper != -1 && tokens != NULL &&
+      jsmn_add_child(&tokens[parser->toksuper]) < 0) {
+    return JSMN_ERROR_RANGE;
+  }
+  parser->pos++;
+  return 0;
+}
+
+/**
+ * Handles the character at the current parser position. Returns the number of
+ * tokens found (0 or 1) or an error.
+ */
+JSMN_INLINE int jsmn_parse_symbol(jsmn_parser *parser, const char *js,
+                                  const size_t len, jsmntok_t *tokens,
+                                  const size_t num_tokens) {
+  int r;
+#if !defined(JSMN_MAX_DEPTH) && !defined(JSMN_PARENT_LINKS)
+  jsmnint_t i;
+#endif
+  jsmntok_t *token;
+  jsmntype_t type;
+  char c;
+
+  c = js[parser->pos];
+  switch (c) {
+  case '{':
+  case '[':
+    if (tokens == NULL) {
+      JSMN_STATS_ADD(parser, tokens[c == '{' ? JSMN_OBJECT : JSMN_ARRAY], 1);
+      return 1;
+    }
+#ifdef JSMN_MAX_DEPTH
+    if (parser->depth >= JSMN_MAX_DEPTH) {
+      return JSMN_ERROR_DEPTH;
+    }
+#endif
+    token = jsmn_alloc_token(parser, tokens, num_tokens);
+    if (token == NULL) {
+      return JSMN_ERROR_NOMEM;
+    }
+    if (parser->toksuper != -1) {
+      jsmntok_t *t = &tokens[parser->toksuper];
+#ifdef JSMN_STRICT
+      /* In strict mode an object or array can't become a key */
+      if (t->type == JSMN_OBJECT) {
         return JSMN_ERROR_INVAL;
       }
-      for (; i >= 0; i--) {
-        token = &tokens[i];
-        if (token->start != -1 && token->end == -1) {
-          parser->toksuper = i;
-          break;
-        }
+#endif
+      if (jsmn_add_child(t) < 0) {
+        return JSMN_ERROR_RANGE;
       }
+#ifdef JSMN_PARENT_LINKS
+      token->parent = parser->toksuper;
+#endif
+    }
+    token->type = (c == '{' ? JSMN_OBJECT : JSMN_ARRAY);
+    token->start = parser->pos;
+    parser->toksuper = parser->toknext - 1;
+#ifdef JSMN_MAX_DEPTH
+    parser->stack[parser->depth] = parser->toksuper;
+#endif
+    parser->depth++;
+    JSMN_STATS_ADD(parser, tokens[token->type], 1);
+#ifdef JSMN_STATS
+    if (parser->depth > parser->stats.max_depth) {
+      parser->stats.max_depth = parser->depth;
+    }
 #endif
+    return 1;
+  case '}':
+  case ']':
+    if (tokens == NULL) {
       break;
-    case '\"':
-      r = jsmn_parse_string(parser, js, len, tokens, num_tokens);
-      if (r < 0) {
-        return r;
+    }
+    type = (c == '}' ? JSMN_OBJECT : JSMN_ARRAY);
+#if defined(JSMN_MAX_DEPTH)
+    /* The innermost open container is always on top of the stack */
+    if (parser->depth == 0) {
+      return JSMN_ERROR_INVAL;
+    }
+    token = &tokens[parser->stack[parser->depth - 1]];
+    if (token->type != type) {
+      return JSMN_ERROR_INVAL;
+    }
+    token->end = parser->pos + 1;
+#ifdef JSMN_SKIP_LINKS
+    token->next = parser->toknext;
+#endif
+    parser->depth--;
+    parser->toksuper =
+        parser->depth > 0 ? parser->stack[parser->depth - 1] : -1;
+#elif defined(JSMN_PARENT_LINKS)
+    if (parser->toknext < 1) {
+      return JSMN_ERROR_INVAL;
+    }
+    token = &tokens[parser->toknext - 1];
+    for (;;) {
+      if (token->start != -1 && token->end == -1) {
+        if (token->type != type) {
+          return JSMN_ERROR_INVAL;
+        }
+        token->end = parser->pos + 1;
+#ifdef JSMN_SKIP_LINKS
+        token->next = parser->toknext;
+#endif
+        parser->depth--;
+        parser->toksuper = token->parent;
+        break;
       }
-      count++;
-      if (parser->toksuper != -1 && tokens != NULL) {
-        tokens[parser->toksuper].size++;
+      if (token->parent == -1) {
+        if (token->type != type || parser->toksuper == -1) {
+          return JSMN_ERROR_INVAL;
+        }
+        break;
       }
-      break;
-    case '\t':
-    case '\r':
-    case '\n':
-    case ' ':
-      break;
-    case ':':
-      parser->toksuper = parser->toknext - 1;
-      break;
-    case ',':
-      if (tokens != NULL && parser->toksuper != -1 &&
-          tokens[parser->toksuper].type != JSMN_ARRAY &&
-          tokens[parser->toksuper].type != JSMN_OBJECT) {
-#ifdef JSMN_PARENT_LINKS
-        parser->toksuper = tokens[parser->toksuper].parent;
+      token = &tokens[token->parent];
+      JSMN_STATS_ADD(parser, scan_steps, 1);
+    }
 #else
-        for (i = parser->toknext - 1; i >= 0; i--) {
-          if (tokens[i].type == JSMN_ARRAY || tokens[i].type == JSMN_OBJECT) {
-            if (tokens[i].start != -1 && tokens[i].end == -1) {
-              parser->toksuper = i;
-              break;
-            }
-          }
+    for (i = parser->toknext - 1; i >= 0; i--) {
+      token = &tokens[i];
+      JSMN_STATS_ADD(parser, scan_steps, 1);
+      if (token->start != -1 && token->end == -1) {
+        if (token->type != type) {
+          return JSMN_ERROR_INVAL;
         }
+        parser->toksuper = -1;
+        token->end = parser->pos + 1;
+#ifdef JSMN_SKIP_LINKS
+        token->next = parser->toknext;
 #endif
+        parser->depth--;
+        break;
       }
-      break;
-#ifdef JSMN_STRICT
-    /* In strict mode primitives are: numbers and booleans */
-    case '-':
-    case '0':
-    case '1':
-    case '2':
-    case '3':
-    case '4':
-    case '5':
-    case '6':
-    case '7':
-    case '8':
-    case '9':
-    case 't':
-    case 'f':
-    case 'n':
-      /* And they must not be keys of the object */
-      if (tokens != NULL && parser->toksuper != -1) {
-        const jsmntok_t *t = &tokens[parser->toksuper];
-        if (t->type == JSMN_OBJECT ||
-            (t->type == JSMN_STRING && t->size != 0)) {
-          return JSMN_ERROR_INVAL;
+    }
+    /* Error if unmatched closing bracket */
+    if (i == -1) {
+      return JSMN_ERROR_INVAL;
+    }
+    for (; i >= 0; i--) {
+      token = &tokens[i];
+      JSMN_STATS_ADD(parser, scan_steps, 1);
+      if (token->start != -1 && token->end == -1) {
+        parser->toksuper = i;
+        break;
+      }
+    }
+#endif
+    break;
+  case '\"':
+    r = jsmn_parse_string(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    JSMN_STATS_ADD(parser, tokens[JSMN_STRING], 1);
+    if (parser->toksuper != -1 && tokens != NULL &&
+        jsmn_add_child(&tokens[parser->toksuper]) < 0) {
+      return JSMN_ERROR_RANGE;
+    }
+    return 1;
+  case '\t':
+  case '\r':
+  case '\n':
+  case ' ':
+    break;
+  case ':':
+    parser->toksuper = parser->toknext - 1;
+    break;
+  case ',':
+    if (tokens != NULL && parser->toksuper != -1 &&
+        tokens[parser->toksuper].type != JSMN_ARRAY &&
+        tokens[parser->toksuper].type != JSMN_OBJECT) {
+#if defined(JSMN_MAX_DEPTH)
+      parser->toksuper =
+          parser->depth > 0 ? parser->stack[parser->depth - 1] : -1;
+#elif defined(JSMN_PARENT_LINKS)
+      parser->toksuper = tokens[parser->toksuper].parent;
+#else
+      for (i = parser->toknext - 1; i >= 0; i--) {
+        JSMN_STATS_ADD(parser, scan_steps, 1);
+        if (tokens[i].type == JSMN_ARRAY || tokens[i].type == JSMN_OBJECT) {
+          if (tokens[i].start != -1 && tokens[i].end == -1) {
+            parser->toksuper = i;
+            break;
+          }
         }
       }
+#endif
+    }
+    break;
+#ifdef JSMN_STRICT
+  /* In strict mode primitives are: numbers and booleans */
+  case '-':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+  case 't':
+  case 'f':
+  case 'n':
+    /* And they must not be keys of the object */
+    if (tokens != NULL && parser->toksuper != -1) {
+      const jsmntok_t *t = &tokens[parser->toksuper];
+      if (t->type == JSMN_OBJECT ||
+          (t->type == JSMN_STRING && t->size != 0)) {
+        return JSMN_ERROR_INVAL;
+      }
+    }
 #else
-    /* In non-strict mode every unquoted value is a primitive */
-    default:
+  /* In non-strict mode every unquoted value is a primitive */
+  default:
 #endif
-      r = jsmn_parse_primitive(parser, js, len, tokens, num_tokens);
-      if (r < 0) {
+    r = jsmn_parse_primitive(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    JSMN_STATS_ADD(parser, tokens[JSMN_PRIMITIVE], 1);
+    if (parser->toksuper != -1 && tokens != NULL &&
+        jsmn_add_child(&tokens[parser->toksuper]) < 0) {
+      return JSMN_ERROR_RANGE;
+    }
+    return 1;
+
+#ifdef JSMN_STRICT
+  /* Unexpected char in strict mode */
+  default:
+    return JSMN_ERROR_INVAL;
+#endif
+  }
+  return 0;
+}
+
+/**
+ * Checks that every opened object or array has been closed.
+ */
+static int jsmn_parse_end(const jsmn_parser *parser, const jsmntok_t *tokens) {
+  /* Unmatched opened object or array */
+  if (tokens != NULL && parser->depth > 0) {
+    return JSMN_ERROR_PART;
+  }
+  return 0;
+}
+
+#ifdef JSMN_STATS
+/**
+ * Counts the bytes a call has scanned from the given position on, and whether
+ * it continues after JSMN_ERROR_PART. Returns the result of the call.
+ */
+static jsmnint_t jsmn_stats_call(jsmn_parser *parser, const jsmnuint_t from,
+                                 const jsmnint_t r) {
+  jsmn_stats *stats = &parser->stats;
+  const size_t to = parser->pos;
+
+  if (to > from) {
+    stats->bytes += to - from;
+    if (stats->scanned_end > from) {
+      stats->rescanned += (to < stats->scanned_end ? to : stats->scanned_end) -
+                          from;
+    }
+    if (to > stats->scanned_end) {
+      stats->scanned_end = to;
+    }
+  }
+  if (stats->partial) {
+    stats->restarts++;
+  }
+  stats->partial = r == JSMN_ERROR_PART;
+  return r;
+}
+#define JSMN_STATS_CALL(parser, from, r) jsmn_stats_call(parser, from, r)
+#else
+#define JSMN_STATS_CALL(parser, from, r) (r)
+#endif
+
+/**
+ * Parse JSON string and fill tokens.
+ */
+JSMN_API jsmnint_t jsmn_parse(jsmn_parser *parser, const char *js,
+                              const size_t len, jsmntok_t *tokens,
+                              const jsmnuint_t num_tokens) {
+  int r;
+  jsmnint_t count = (jsmnint_t)parser->toknext;
+#ifdef JSMN_STATS
+  const jsmnuint_t from = parser->pos;
+#endif
+
+  if (parser->tokstart != -1) {
+    r = jsmn_parse_resume(parser, js, len, tokens, num_tokens, &count);
+    if (r < 0) {
+      return JSMN_STATS_CALL(parser, from, r);
+    }
+  }
+
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+    r = jsmn_parse_symbol(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return JSMN_STATS_CALL(parser, from, r);
+    }
+    count += r;
+  }
+
+  r = jsmn_parse_end(parser, tokens);
+  if (r < 0) {
+    return JSMN_STATS_CALL(parser, from, r);
+  }
+  return JSMN_STATS_CALL(parser, from, count);
+}
+
+/**
+ * Parse JSON string growing the tokens array when needed.
+ */
+JSMN_API jsmnint_t jsmn_parse_realloc(jsmn_parser *parser, const char *js,
+                                      const size_t len, jsmntok_t **tokens,
+                                      jsmnuint_t *num_tokens,
+                                      void *(*grow)(void *user, void *ptr,
+                                                    size_t size),
+                                      void *user) {
+  jsmnint_t r;
+  jsmnuint_t n;
+  size_t size;
+  void *p;
+
+  for (;;) {
+    /* A token that didn't fit is picked up where the parser stopped, so
+     * nothing is parsed twice */
+    if (*tokens != NULL) {
+      r = jsmn_parse(parser, js, len, *tokens, *num_tokens);
+      if (r != JSMN_ERROR_NOMEM) {
         return r;
       }
-      count++;
-      if (parser->toksuper != -1 && tokens != NULL) {
-        tokens[parser->toksuper].size++;
-      }
-      break;
+    }
+    n = *num_tokens < 8 ? 16 : *num_tokens * 2;
+    size = (size_t)n * sizeof(jsmntok_t);
+    if (n < *num_tokens || size / sizeof(jsmntok_t) != n) {
+      return JSMN_ERROR_NOMEM;
+    }
+    p = grow(user, *tokens, size);
+    if (p == NULL) {
+      return JSMN_ERROR_NOMEM;
+    }
+    *tokens = (jsmntok_t *)p;
+    *num_tokens = n;
+  }
+}
 
-#ifdef JSMN_STRICT
-    /* Unexpected char in strict mode */
+/**
+ * Classifies 32 bytes of input, setting one bit per byte in each mask.
+ */
+static void jsmn_classify(const char *js, unsigned long *quote,
+                          unsigned long *bslash, unsigned long *ws,
+                          unsigned long *op) {
+  int k;
+#ifdef JSMN_SIMD_SSE2
+  *quote = *bslash = *ws = *op = 0;
+  for (k = 0; k < 32; k += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(js + k));
+    __m128i w = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')),
+                     _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+    __m128i o = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')),
+                                  _mm_cmpeq_epi8(v, _mm_set1_epi8(']')))),
+        _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                         _mm_cmpeq_epi8(v, _mm_set1_epi8(','))),
+            _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+    *quote |= (unsigned long)_mm_movemask_epi8(
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8('\"')))
+              << k;
+    *bslash |= (unsigned long)_mm_movemask_epi8(
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))
+               << k;
+    *ws |= (unsigned long)_mm_movemask_epi8(w) << k;
+    *op |= (unsigned long)_mm_movemask_epi8(o) << k;
+  }
+#else
+  *quote = *bslash = *ws = *op = 0;
+  for (k = 0; k < 32; k++) {
+    unsigned long bit = 1UL << k;
+    switch (js[k]) {
+    case '\"':
+      *quote |= bit;
+      break;
+    case '\\':
+      *bslash |= bit;
+      break;
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+      *ws |= bit;
+      break;
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '\0':
+      *op |= bit;
+      break;
     default:
-      return JSMN_ERROR_INVAL;
+      break;
+    }
+  }
 #endif
+}
+
+/**
+ * Finds structural characters of a 32-byte block. Bytes preceded by an odd
+ * number of backslashes are escaped, prefix XOR of the remaining quotes gives
+ * the bytes inside strings, and primitives start wherever a byte that is not
+ * whitespace, a bracket, a colon, a comma or a quote follows one that is.
+ * carry keeps the escape, string and primitive state between blocks and must
+ * start zeroed. Also returns the operator bytes and the bytes inside strings.
+ */
+JSMN_INLINE unsigned long jsmn_scan_block(const char *block,
+                                          unsigned long carry[3],
+                                          unsigned long *op,
+                                          unsigned long *instr) {
+  const unsigned long all = 0xFFFFFFFFUL;
+  unsigned long quote, bslash, ws;
+  unsigned long escaped, b, scalar, structural;
+
+  jsmn_classify(block, &quote, &bslash, &ws, op);
+
+  escaped = carry[0];
+  b = bslash & ~carry[0];
+  carry[0] = 0;
+  while (b != 0) {
+    unsigned long bit = b & (~b + 1);
+    if (bit & 0x80000000UL) {
+      carry[0] = 1;
+    } else {
+      escaped |= bit << 1;
     }
+    b &= ~(bit | (bit << 1));
   }
 
-  if (tokens != NULL) {
-    for (i = parser->toknext - 1; i >= 0; i--) {
-      /* Unmatched opened object or array */
-      if (tokens[i].start != -1 && tokens[i].end == -1) {
-        return JSMN_ERROR_PART;
+  quote &= ~escaped;
+  b = quote ^ (quote << 1);
+  b ^= b << 2;
+  b ^= b << 4;
+  b ^= b << 8;
+  b ^= b << 16;
+  *instr = (b ^ carry[1]) & all;
+  carry[1] = (*instr & 0x80000000UL) ? all : 0;
+
+  scalar = ~(ws | *op | quote | *instr) & all;
+  structural = (*op & ~*instr) | (quote & *instr) |
+               (scalar & ~((scalar << 1) | carry[2]));
+  carry[2] = (scalar >> 31) & 1;
+  return structural & all;
+}
+
+/**
+ * Finds structural characters 32 bytes at a time.
+ */
+JSMN_API jsmnint_t jsmn_structurals(const char *js, const size_t len,
+                                    jsmnuint_t *indices,
+                                    const jsmnuint_t num_indices) {
+  unsigned long carry[3] = {0, 0, 0};
+  jsmnuint_t count = 0;
+  size_t base;
+  char tail[32];
+
+  for (base = 0; base < len; base += 32) {
+    const char *block = js + base;
+    unsigned long op, instr, structural;
+
+    if (len - base < 32) {
+      size_t k;
+      for (k = 0; k < 32; k++) {
+        tail[k] = k < len - base ? block[k] : ' ';
+      }
+      block = tail;
+    }
+    structural = jsmn_scan_block(block, carry, &op, &instr);
+
+    for (; structural != 0; structural &= structural - 1) {
+      if (indices != NULL) {
+        if (count >= num_indices) {
+          return JSMN_ERROR_NOMEM;
+        }
+        indices[count] = (jsmnuint_t)base + jsmn_ctz(structural);
       }
+      count++;
     }
   }
+  return (jsmnint_t)count;
+}
 
-  return count;
+#ifdef JSMN_SIMD_SSE2
+/**
+ * Finds opening and closing brackets and NUL bytes of a 32-byte block.
+ */
+static void jsmn_classify_brackets(const char *js, unsigned long *open,
+                                   unsigned long *close, unsigned long *nul) {
+  int k;
+  *open = *close = *nul = 0;
+  for (k = 0; k < 32; k += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(js + k));
+    *open |= (unsigned long)_mm_movemask_epi8(
+                 _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+                              _mm_cmpeq_epi8(v, _mm_set1_epi8('['))))
+             << k;
+    *close |= (unsigned long)_mm_movemask_epi8(
+                  _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('}')),
+                               _mm_cmpeq_epi8(v, _mm_set1_epi8(']'))))
+              << k;
+    *nul |= (unsigned long)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(v, _mm_setzero_si128()))
+            << k;
+  }
 }
+#endif
 
 /**
- * Creates a new parser based over a given buffer with an array of tokens
- * available.
+ * Measures JSON string from structural characters only. With SIMD whole
+ * blocks are classified at once, otherwise a plain loop is faster than
+ * building the masks byte by byte.
  */
-JSMN_API void jsmn_init(jsmn_parser *parser) {
-  parser->pos = 0;
-  parser->toknext = 0;
-  parser->toksuper = -1;
+JSMN_API jsmnint_t jsmn_measure(const char *js, const size_t len,
+                                unsigned int *max_depth) {
+  jsmnuint_t count = 0;
+  unsigned int depth = 0;
+  unsigned int deepest = 0;
+  int instring = 0;
+  size_t end = len;
+#ifdef JSMN_SIMD_SSE2
+  unsigned long carry[3] = {0, 0, 0};
+  size_t base;
+  char tail[32];
+
+  for (base = 0; base < end; base += 32) {
+    const char *block = js + base;
+    unsigned long op, instr, structural, open, close, nul, b;
+
+    if (len - base < 32) {
+      size_t k;
+      for (k = 0; k < 32; k++) {
+        tail[k] = k < len - base ? block[k] : ' ';
+      }
+      block = tail;
+    }
+    structural = jsmn_scan_block(block, carry, &op, &instr);
+    jsmn_classify_brackets(block, &open, &close, &nul);
+    instring = carry[1] != 0;
+    if (nul != 0) {
+      /* Like jsmn_parse(), stop at the first NUL byte */
+      b = nul & (~nul + 1);
+      end = base + jsmn_ctz(nul);
+      instring = (instr & b) != 0;
+      structural &= b - 1;
+      open &= b - 1;
+      close &= b - 1;
+    }
+    open &= ~instr;
+    close &= ~instr;
+
+    count += jsmn_popcount((structural & ~op) | open);
+    for (b = open | close; b != 0; b &= b - 1) {
+      if (open & b & (~b + 1)) {
+        if (++depth > deepest) {
+          deepest = depth;
+        }
+      } else if (depth-- == 0) {
+        return JSMN_ERROR_INVAL;
+      }
+    }
+  }
+#else
+  int escape = 0;
+  int scalar = 0;
+
+  for (end = 0; end < len && js[end] != '\0'; end++) {
+    char c = js[end];
+    if (instring) {
+      if (escape) {
+        escape = 0;
+      } else if (c == '\\') {
+        escape = 1;
+      } else if (c == '\"') {
+        instring = 0;
+      }
+      continue;
+    }
+    switch (c) {
+    case '{':
+    case '[':
+      count++;
+      if (++depth > deepest) {
+        deepest = depth;
+      }
+      scalar = 0;
+      break;
+    case '}':
+    case ']':
+      if (depth-- == 0) {
+        return JSMN_ERROR_INVAL;
+      }
+      scalar = 0;
+      break;
+    case '\"':
+      count++;
+      instring = 1;
+      scalar = 0;
+      break;
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+    case ',':
+    case ':':
+      scalar = 0;
+      break;
+    default:
+      /* First character of a primitive */
+      if (!scalar) {
+        count++;
+        scalar = 1;
+      }
+      break;
+    }
+  }
+#endif
+
+  if (max_depth != NULL) {
+    *max_depth = deepest;
+  }
+  /* Unclosed string, object or array */
+  if (instring || depth > 0) {
+    return JSMN_ERROR_PART;
+  }
+#ifdef JSMN_STRICT
+  /* In strict mode primitive must be followed by a comma/object/array */
+  if (end > 0) {
+    switch (js[end - 1]) {
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+    case ',':
+    case ':':
+    case '\"':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+      break;
+    default:
+      return JSMN_ERROR_PART;
+    }
+  }
+#endif
+  return (jsmnint_t)count;
+}
+
+/**
+ * Parse JSON string jumping between structural characters.
+ */
+JSMN_API jsmnint_t jsmn_parse_structurals(jsmn_parser *parser,
+                                          const char *js, const size_t len,
+                                          const jsmnuint_t *indices,
+                                          const jsmnuint_t num_indices,
+                                          jsmntok_t *tokens,
+                                          const jsmnuint_t num_tokens) {
+  jsmnint_t r;
+  jsmnuint_t i;
+  jsmnuint_t start = parser->pos;
+  jsmnint_t count = (jsmnint_t)parser->toknext;
+
+  if (parser->tokstart != -1) {
+    r = jsmn_parse_resume(parser, js, len, tokens, num_tokens, &count);
+    if (r < 0) {
+      return r;
+    }
+  }
+
+  for (i = 0; i < num_indices; i++) {
+    if (indices[i] < parser->pos) {
+      if (indices[i] >= start && js[indices[i]] == '\"') {
+        /* A quote inside a non-strict primitive, the string boundaries found
+         * by jsmn_structurals() can't be trusted anymore */
+        r = jsmn_parse(parser, js, len, tokens, num_tokens);
+        if (r < 0) {
+          return r;
+        }
+        return tokens == NULL ? count + r : r;
+      }
+      continue;
+    }
+    parser->pos = indices[i];
+    if (parser->pos >= len || js[parser->pos] == '\0') {
+      break;
+    }
+    r = jsmn_parse_symbol(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    count += r;
+    parser->pos++;
+  }
+  if (i == num_indices) {
+    parser->pos = (jsmnuint_t)len;
+  }
+
+  r = jsmn_parse_end(parser, tokens);
+  if (r < 0) {
+    return r;
+  }
+  return count;
+}
+
+/* Progress of jsmn_parse_next_element() through the top-level array */
+#define JSMN_ELEMENT_START 0 /* before the opening bracket */
+#define JSMN_ELEMENT_NEXT 1  /* after the opening bracket or a comma */
+#define JSMN_ELEMENT_IN 2    /* inside of an element */
+#define JSMN_ELEMENT_AFTER 3 /* after an element */
+#define JSMN_ELEMENT_END 4   /* after the closing bracket */
+
+#ifndef JSMN_STRICT
+/**
+ * Takes back a primitive that ends at the end of input, the next chunk of
+ * data may continue it.
+ */
+static int jsmn_unparse_primitive(jsmn_parser *parser, const char *js,
+                                  const size_t len, jsmntok_t *tokens) {
+  const jsmntok_t *token = &tokens[parser->toknext - 1];
+  if (token->type != JSMN_PRIMITIVE ||
+      ((size_t)token->end < len && js[token->end] != '\0')) {
+    return 0;
+  }
+  parser->toknext--;
+  if (parser->toksuper != -1) {
+    tokens[parser->toksuper].size--;
+  }
+  parser->tokstart = token->start;
+  parser->pos = token->end;
+  return JSMN_ERROR_PART;
+}
+#endif
+
+/**
+ * Parse the next element of a top-level JSON array.
+ */
+JSMN_API jsmnint_t jsmn_parse_next_element(jsmn_parser *parser,
+                                           const char *js, const size_t len,
+                                           jsmntok_t *tokens,
+                                           const jsmnuint_t num_tokens) {
+  jsmnint_t r;
+  jsmnint_t count = 0;
+
+  /* Elements are taken back from their tokens, there is no counting mode */
+  if (tokens == NULL) {
+    return JSMN_ERROR_INVAL;
+  }
+  if (parser->tokstart != -1) {
+    r = jsmn_parse_resume(parser, js, len, tokens, num_tokens, &count);
+#ifndef JSMN_STRICT
+    if (r == 0) {
+      r = jsmn_unparse_primitive(parser, js, len, tokens);
+    }
+#endif
+    if (r < 0) {
+      return r;
+    }
+    if (parser->depth == 0) {
+      parser->element = JSMN_ELEMENT_AFTER;
+      return (jsmnint_t)parser->toknext;
+    }
+  }
+
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+    char c = js[parser->pos];
+    switch (parser->element) {
+    case JSMN_ELEMENT_START:
+      if (c == '[') {
+        parser->element = JSMN_ELEMENT_NEXT;
+      } else if (c != '\t' && c != '\r' && c != '\n' && c != ' ') {
+        return JSMN_ERROR_INVAL;
+      }
+      break;
+    case JSMN_ELEMENT_NEXT:
+      if (c == '\t' || c == '\r' || c == '\n' || c == ' ') {
+        break;
+      }
+      if (c == ']') {
+        parser->element = JSMN_ELEMENT_END;
+        parser->pos++;
+        return 0;
+      }
+      if (c == ',' || c == ':') {
+        return JSMN_ERROR_INVAL;
+      }
+      /* Tokens of the previous element are not needed anymore */
+      parser->toknext = 0;
+      parser->toksuper = -1;
+      parser->element = JSMN_ELEMENT_IN;
+      /* fall through */
+    case JSMN_ELEMENT_IN:
+      r = jsmn_parse_symbol(parser, js, len, tokens, num_tokens);
+#ifndef JSMN_STRICT
+      if (r > 0) {
+        r = jsmn_unparse_primitive(parser, js, len, tokens);
+      }
+#endif
+      if (r < 0) {
+        return r;
+      }
+      if (parser->depth == 0) {
+        parser->element = JSMN_ELEMENT_AFTER;
+        parser->pos++;
+        return (jsmnint_t)parser->toknext;
+      }
+      break;
+    case JSMN_ELEMENT_AFTER:
+      if (c == ',') {
+        parser->element = JSMN_ELEMENT_NEXT;
+      } else if (c == ']') {
+        parser->element = JSMN_ELEMENT_END;
+        parser->pos++;
+        return 0;
+      } else if (c != '\t' && c != '\r' && c != '\n' && c != ' ') {
+        return JSMN_ERROR_INVAL;
+      }
+      break;
+    default:
+      return 0;
+    }
+  }
+  return parser->element == JSMN_ELEMENT_END ? 0 : JSMN_ERROR_PART;
+}
+
+/**
+ * Returns the offset of the next newline, or len.
+ */
+static jsmnuint_t jsmn_find_newline(const char *js, jsmnuint_t pos,
+                                    const size_t len) {
+#ifdef JSMN_SIMD_SSE2
+  const __m128i nl = _mm_set1_epi8('\n');
+  for (; pos + 16 <= len; pos += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(js + pos));
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl));
+    if (mask != 0) {
+      return pos + jsmn_ctz(mask);
+    }
+  }
+#endif
+  for (; pos < len && js[pos] != '\n'; pos++) {
+  }
+  return pos;
+}
+
+/**
+ * Parse newline-delimited JSON. Each line is parsed on its own, so a broken
+ * record only affects its own line and parsing resumes at the next one.
+ */
+JSMN_API int jsmn_parse_lines(jsmn_parser *parser, const char *js,
+                              const size_t len, jsmntok_t *tokens,
+                              const jsmnuint_t num_tokens,
+                              jsmn_record *records,
+                              const unsigned int num_records) {
+  unsigned int n = 0;
+  jsmnuint_t first = 0;
+
+  if (tokens == NULL || records == NULL) {
+    return JSMN_ERROR_INVAL;
+  }
+  while (n < num_records && parser->pos < len && js[parser->pos] != '\0') {
+    jsmnuint_t start = parser->pos;
+    jsmnuint_t end = jsmn_find_newline(js, start, len);
+    jsmnint_t r;
+
+    /* Every record is parsed as a document of its own in the rest of the
+     * tokens array, so looking for enclosing tokens never goes past it */
+    parser->toknext = 0;
+    parser->toksuper = -1;
+    parser->depth = 0;
+    parser->tokstart = -1;
+    parser->escape = 0;
+#ifdef JSMN_STATS
+    parser->stats.partial = 0; /* a truncated record is not continued */
+#endif
+    /* The newline ends a primitive even in strict mode */
+    r = jsmn_parse(parser, js, end < len ? end + 1 : end, tokens + first,
+                   num_tokens - first);
+    if (r == JSMN_ERROR_NOMEM) {
+      /* Start over with this record in the next call */
+      parser->pos = start;
+      if (n == 0) {
+        return JSMN_ERROR_NOMEM;
+      }
+      break;
+    }
+    parser->pos = end < len ? end + 1 : end;
+    if (r == 0) {
+      continue; /* blank line */
+    }
+    records[n].token = (jsmnint_t)first;
+    records[n].count = r < 0 ? 0 : r;
+    records[n].start = (jsmnint_t)start;
+    records[n].end = (jsmnint_t)end;
+    records[n].error = r < 0 ? (int)r : 0;
+    first += (jsmnuint_t)records[n].count;
+    n++;
+  }
+  return (int)n;
+}
+
+/**
+ * Split newline-delimited JSON at the first line break after each of the
+ * evenly spaced offsets. Parts may be empty if lines are long.
+ */
+JSMN_API void jsmn_split_lines(const char *js, const size_t len,
+                               jsmnuint_t *bounds,
+                               const unsigned int num_parts) {
+  unsigned int i;
+  jsmnuint_t pos;
+
+  bounds[0] = 0;
+  for (i = 1; i < num_parts; i++) {
+    pos = (jsmnuint_t)(len / num_parts * i);
+    if (pos <= bounds[i - 1]) {
+      /* The previous part already covers this one */
+      bounds[i] = bounds[i - 1];
+      continue;
+    }
+    /* Starting at the character before keeps a line that begins at pos */
+    pos = jsmn_find_newline(js, pos - 1, len);
+    bounds[i] = pos < len ? pos + 1 : pos;
+  }
+  bounds[num_parts] = (jsmnuint_t)len;
+}
+
+/**
+ * Tells whether the byte at pos is preceded by an odd number of backslashes.
+ */
+static int jsmn_escaped_at(const char *js, const jsmnuint_t pos) {
+  jsmnuint_t i = pos;
+  while (i > 0 && js[i - 1] == '\\') {
+    i--;
+  }
+  return (int)((pos - i) & 1);
+}
+
+/**
+ * Scan a chunk for quotes, brackets and commas. Whether a byte is inside a
+ * string depends on all chunks before, so brackets are counted for both cases:
+ * if the chunk starts inside a string, bytes inside and outside simply swap.
+ * Commas are only found inside the array, at depth 1 or more, so a comma of
+ * the array itself is at the lowest depth of any comma in the chunk.
+ */
+JSMN_API void jsmn_scan_chunk(const char *js, const size_t len,
+                              jsmn_chunk *chunk) {
+  jsmnuint_t end = chunk->end < len ? chunk->end : (jsmnuint_t)len;
+#ifdef JSMN_SIMD_SSE2
+  unsigned long carry[3] = {0, 0, 0};
+  jsmnuint_t base;
+  char tail[32];
+  int s;
+
+  chunk->depth[0] = chunk->depth[1] = 0;
+  chunk->comma[0] = chunk->comma[1] = (jsmnuint_t)-1;
+  carry[0] = (unsigned long)jsmn_escaped_at(js, chunk->start);
+  for (base = chunk->start; base < end; base += 32) {
+    const char *block = js + base;
+    unsigned long op, instr, open, close, nul, m, b;
+    jsmnint_t depth;
+
+    if (end - base < 32) {
+      jsmnuint_t k;
+      for (k = 0; k < 32; k++) {
+        tail[k] = k < end - base ? block[k] : ' ';
+      }
+      block = tail;
+    }
+    jsmn_scan_block(block, carry, &op, &instr);
+    jsmn_classify_brackets(block, &open, &close, &nul);
+    for (s = 0; s < 2; s++) {
+      m = s ? instr : ~instr;
+      /* Go through the block only if a comma could be lower than before */
+      if ((op & m & ~(open | close)) == 0 ||
+          (chunk->comma[s] != (jsmnuint_t)-1 &&
+           chunk->depth[s] - (jsmnint_t)jsmn_popcount(close & m) >=
+               chunk->low[s])) {
+        continue;
+      }
+      depth = chunk->depth[s];
+      for (b = op & m; b != 0; b &= b - 1) {
+        unsigned int k = jsmn_ctz(b);
+        if (open & (1UL << k)) {
+          depth++;
+        } else if (close & (1UL << k)) {
+          depth--;
+        } else if (block[k] == ',' && (chunk->comma[s] == (jsmnuint_t)-1 ||
+                                       depth < chunk->low[s])) {
+          chunk->low[s] = depth;
+          chunk->comma[s] = base + k;
+        }
+      }
+    }
+    chunk->depth[0] += (int)jsmn_popcount(open & ~instr) -
+                       (int)jsmn_popcount(close & ~instr);
+    chunk->depth[1] +=
+        (int)jsmn_popcount(open & instr) - (int)jsmn_popcount(close & instr);
+  }
+  chunk->quotes = carry[1] != 0;
+#else
+  jsmnuint_t pos;
+  int escape = jsmn_escaped_at(js, chunk->start);
+  int instring = 0;
+
+  chunk->depth[0] = chunk->depth[1] = 0;
+  chunk->comma[0] = chunk->comma[1] = (jsmnuint_t)-1;
+  for (pos = chunk->start; pos < end; pos++) {
+    char c = js[pos];
+    if (escape) {
+      escape = 0;
+    } else if (c == '\\') {
+      escape = 1;
+    } else if (c == '\"') {
+      instring = !instring;
+    } else if (c == '[' || c == '{') {
+      chunk->depth[instring]++;
+    } else if (c == ']' || c == '}') {
+      chunk->depth[instring]--;
+    } else if (c == ',' && (chunk->comma[instring] == (jsmnuint_t)-1 ||
+                            chunk->depth[instring] < chunk->low[instring])) {
+      chunk->low[instring] = chunk->depth[instring];
+      chunk->comma[instring] = pos;
+    }
+  }
+  chunk->quotes = instring;
+#endif
+}
+
+/**
+ * Split the top-level array. With the string state and depth at the start of
+ * every chunk known from the chunks before it, each part starts right after
+ * the first comma of the array in the chunk, which the scan has recorded.
+ */
+JSMN_API int jsmn_split_array(const char *js, const size_t len,
+                              jsmn_chunk *chunks,
+                              const unsigned int num_chunks) {
+  unsigned int i;
+  jsmnuint_t pos;
+  int instring = 0;
+  jsmnint_t depth = 0;
+
+  for (pos = 0; pos < len && (js[pos] == ' ' || js[pos] == '\t' ||
+                              js[pos] == '\r' || js[pos] == '\n');
+       pos++) {
+  }
+  if (pos == len || js[pos] != '[' || chunks[0].start != 0) {
+    return JSMN_ERROR_INVAL;
+  }
+  for (i = 0; i < num_chunks; i++) {
+    chunks[i].split = i == 0 ? 0 : (jsmnuint_t)-1;
+    if (i > 0 && depth >= 1 &&
+        chunks[i].comma[instring] != (jsmnuint_t)-1 &&
+        depth + chunks[i].low[instring] == 1) {
+      chunks[i].split = chunks[i].comma[instring] + 1;
+    }
+    depth += chunks[i].depth[instring];
+    instring ^= chunks[i].quotes;
+    if (depth < 0) {
+      return JSMN_ERROR_INVAL;
+    }
+  }
+  /* A chunk within a single element gets an empty part */
+  for (i = num_chunks; i-- > 1;) {
+    if (chunks[i].split == (jsmnuint_t)-1) {
+      chunks[i].split =
+          i + 1 < num_chunks ? chunks[i + 1].split : (jsmnuint_t)len;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Parse one part of the top-level array. Parts after the first one start
+ * inside the array, so the parser gets an open array token first.
+ */
+JSMN_API jsmnint_t jsmn_parse_array_part(jsmn_parser *parser, const char *js,
+                                         const size_t len,
+                                         const jsmn_chunk *chunks,
+                                         const unsigned int num_chunks,
+                                         const unsigned int part,
+                                         jsmntok_t *tokens,
+                                         const jsmnuint_t num_tokens) {
+  jsmnuint_t end =
+      part + 1 < num_chunks ? chunks[part + 1].split : (jsmnuint_t)len;
+  jsmntok_t *array;
+  jsmnint_t r;
+
+  jsmn_init(parser);
+  parser->pos = chunks[part].split;
+  if (part > 0) {
+    array = jsmn_alloc_token(parser, tokens, num_tokens);
+    if (array == NULL) {
+      return JSMN_ERROR_NOMEM;
+    }
+    array->type = JSMN_ARRAY;
+    array->start = 0;
+    parser->toksuper = 0;
+#ifdef JSMN_MAX_DEPTH
+    parser->stack[0] = 0;
+#endif
+    parser->depth = 1;
+    if (parser->pos >= end) {
+      return 1; /* an empty part */
+    }
+  }
+  r = jsmn_parse(parser, js, end, tokens, num_tokens);
+  /* All but the last part end inside the array */
+  if (r == JSMN_ERROR_PART && part + 1 < num_chunks && parser->depth == 1 &&
+      parser->tokstart == -1) {
+    return (jsmnint_t)parser->toknext;
+  }
+  return r;
+}
+
+/**
+ * Append the tokens of a part, shifting links by the position of the part in
+ * the whole array.
+ */
+JSMN_API jsmnint_t jsmn_join_array_part(jsmntok_t *tokens,
+                                        const jsmnuint_t num_tokens,
+                                        const jsmnint_t count,
+                                        const jsmntok_t *part,
+                                        const jsmnint_t part_count) {
+  jsmnint_t i;
+  jsmnint_t offset = count - 1;
+
+  if (count == 0) {
+    /* The first part, maybe parsed right into tokens */
+    if ((jsmnuint_t)part_count > num_tokens) {
+      return JSMN_ERROR_NOMEM;
+    }
+    for (i = 0; i < part_count && part != tokens; i++) {
+      tokens[i] = part[i];
+    }
+    return part_count;
+  }
+  if ((jsmnuint_t)(offset + part_count) > num_tokens) {
+    return JSMN_ERROR_NOMEM;
+  }
+#ifdef JSMN_COMPACT
+  if (part[0].size > JSMN_MAX_SIZE - tokens[0].size) {
+    return JSMN_ERROR_RANGE;
+  }
+#endif
+  tokens[0].size += part[0].size;
+  if (part[0].end != -1) {
+    tokens[0].end = part[0].end;
+#ifdef JSMN_SKIP_LINKS
+    tokens[0].next = part[0].next + offset;
+#endif
+  }
+  for (i = 1; i < part_count; i++) {
+    jsmntok_t *t = &tokens[offset + i];
+    *t = part[i];
+#ifdef JSMN_PARENT_LINKS
+    if (t->parent > 0) {
+      t->parent += offset;
+    }
+#endif
+#ifdef JSMN_SKIP_LINKS
+    if (t->next != -1) {
+      t->next += offset;
+    }
+#endif
+  }
+  return offset + part_count;
+}
+
+#ifdef JSMN_MAX_DEPTH
+/* Without tokens jsmn_parse_events() keeps the type of the token jsmn_parse()
+ * would add the next value to in toksuper, or -1. A key that has its value is
+ * told apart from one waiting for it, as jsmn_parse() does by its size. */
+#define JSMN_EVENT_VALUE 5 /* a key after its value */
+
+/**
+ * Counts a value of the given type for jsmn_parse_events() as jsmn_parse()
+ * would create its token.
+ */
+static void jsmn_event_token(jsmn_parser *parser, const jsmntype_t type) {
+  if (parser->toksuper == JSMN_STRING) {
+    parser->toksuper = JSMN_EVENT_VALUE;
+  }
+  /* A colon makes the last token the superior one */
+  parser->element = (int)type;
+  parser->toknext++;
+}
+
+/**
+ * Makes the innermost open object or array the superior one again.
+ */
+static void jsmn_event_close(jsmn_parser *parser) {
+  parser->toksuper =
+      parser->depth > 0 ? parser->stack[parser->depth - 1] : -1;
+}
+
+/**
+ * Parses a string or primitive for jsmn_parse_events(), including one cut off
+ * by the end of input during the previous call.
+ */
+static int jsmn_parse_event_value(jsmn_parser *parser, const char *js,
+                                  const size_t len, const jsmn_callbacks *cb,
+                                  void *user) {
+  int r;
+  jsmnint_t end;
+  jsmnint_t start =
+      parser->tokstart != -1 ? parser->tokstart : (jsmnint_t)parser->pos;
+  const int string = js[start] == '\"';
+  int (*callback)(void *, jsmnint_t, jsmnint_t);
+
+  if (string) {
+    r = jsmn_parse_string(parser, js, len, NULL, 0);
+    start++;
+    end = (jsmnint_t)parser->pos;
+    callback = cb->string;
+  } else {
+#ifdef JSMN_STRICT
+    /* Primitives must not be keys of the object or follow a value in it */
+    if (parser->toksuper == JSMN_OBJECT ||
+        parser->toksuper == JSMN_EVENT_VALUE) {
+      return JSMN_ERROR_INVAL;
+    }
+#endif
+    r = jsmn_parse_primitive(parser, js, len, NULL, 0);
+    end = (jsmnint_t)parser->pos + 1;
+    callback = cb->primitive;
+#ifndef JSMN_STRICT
+    /* Inside of an object or array the next chunk of data may continue it */
+    if (r == 0 && parser->depth > 0 &&
+        ((size_t)end == len || js[end] == '\0')) {
+      parser->tokstart = start;
+      parser->pos = (jsmnuint_t)end;
+      return JSMN_ERROR_PART;
+    }
+#endif
+  }
+  if (r < 0) {
+    return r;
+  }
+  parser->tokstart = -1;
+  if (parser->toksuper == JSMN_OBJECT) {
+    callback = cb->key;
+  }
+  jsmn_event_token(parser, string ? JSMN_STRING : JSMN_PRIMITIVE);
+  if (callback != NULL && callback(user, start, end) != 0) {
+    return JSMN_ERROR_STOP;
+  }
+  return 0;
+}
+
+/**
+ * Run JSON parser calling back for every value.
+ */
+JSMN_API jsmnint_t jsmn_parse_events(jsmn_parser *parser, const char *js,
+                                     const size_t len, const jsmn_callbacks *cb,
+                                     void *user) {
+  int r;
+  jsmntype_t type;
+
+  /* Without tokens the stack holds types of open objects/arrays */
+  if (parser->tokstart != -1) {
+    r = jsmn_parse_event_value(parser, js, len, cb, user);
+    if (r != 0) {
+      return r;
+    }
+    parser->pos++;
+  }
+
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+    char c = js[parser->pos];
+    switch (c) {
+    case '{':
+    case '[':
+      if (parser->depth >= JSMN_MAX_DEPTH) {
+        return JSMN_ERROR_DEPTH;
+      }
+#ifdef JSMN_STRICT
+      /* In strict mode an object or array can't become a key */
+      if (parser->toksuper == JSMN_OBJECT) {
+        return JSMN_ERROR_INVAL;
+      }
+#endif
+      type = (c == '{' ? JSMN_OBJECT : JSMN_ARRAY);
+      jsmn_event_token(parser, type);
+      parser->stack[parser->depth++] = type;
+      parser->toksuper = type;
+      if (cb->begin != NULL &&
+          cb->begin(user, type, (jsmnint_t)parser->pos) != 0) {
+        return JSMN_ERROR_STOP;
+      }
+      break;
+    case '}':
+    case ']':
+      type = (c == '}' ? JSMN_OBJECT : JSMN_ARRAY);
+      if (parser->depth == 0 ||
+          parser->stack[parser->depth - 1] != (int)type) {
+        return JSMN_ERROR_INVAL;
+      }
+      parser->depth--;
+      jsmn_event_close(parser);
+      if (cb->end != NULL &&
+          cb->end(user, type, (jsmnint_t)parser->pos + 1) != 0) {
+        return JSMN_ERROR_STOP;
+      }
+      break;
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+      break;
+    case ':':
+      parser->toksuper = parser->toknext > 0 ? parser->element : -1;
+      break;
+    case ',':
+      if (parser->toksuper != -1 && parser->toksuper != JSMN_OBJECT &&
+          parser->toksuper != JSMN_ARRAY) {
+        jsmn_event_close(parser);
+      }
+      break;
+#ifdef JSMN_STRICT
+    /* In strict mode primitives are: numbers and booleans */
+    case '\"':
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+    case 't':
+    case 'f':
+    case 'n':
+#else
+    /* In non-strict mode every unquoted value is a primitive */
+    default:
+#endif
+      r = jsmn_parse_event_value(parser, js, len, cb, user);
+      if (r != 0) {
+        return r;
+      }
+      break;
+#ifdef JSMN_STRICT
+    /* Unexpected char in strict mode */
+    default:
+      return JSMN_ERROR_INVAL;
+#endif
+    }
+  }
+
+  /* Unmatched opened object or array */
+  if (parser->depth > 0) {
+    return JSMN_ERROR_PART;
+  }
+  return (jsmnint_t)parser->toknext;
+}
+#endif /* JSMN_MAX_DEPTH */
+
+/**
+ * Skips whitespace and returns the next character, or NUL at the end of input.
+ */
+static char jsmn_skip_ws(jsmn_parser *parser, const char *js,
+                         const size_t len) {
+  for (; parser->pos < len; parser->pos++) {
+    switch (js[parser->pos]) {
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+      break;
+    default:
+      return js[parser->pos];
+    }
+  }
+  return '\0';
+}
+
+#ifdef JSMN_STRICT
+/**
+ * Tells whether a character starts a primitive in strict mode: a number, a
+ * boolean or null.
+ */
+static int jsmn_strict_primitive(const char c) {
+  return c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' ||
+         c == 'n';
+}
+#endif
+
+/**
+ * Skips the value at the parser position without creating tokens and counts
+ * its direct children. Strings and primitives are validated like in
+ * jsmn_parse().
+ */
+static int jsmn_skip_value(jsmn_parser *parser, const char *js,
+                           const size_t len, jsmnint_t *size) {
+  int r;
+  int depth = 0;
+  int object = js[parser->pos] == '{';
+
+  *size = 0;
+  do {
+    char c = parser->pos < len ? js[parser->pos] : '\0';
+    switch (c) {
+    case '\0':
+      return JSMN_ERROR_PART;
+    case '{':
+    case '[':
+      if (depth == 1 && !object) {
+        (*size)++;
+      }
+      depth++;
+      break;
+    case '}':
+    case ']':
+      if (depth == 0) {
+        return JSMN_ERROR_INVAL;
+      }
+      depth--;
+      break;
+    case '\t':
+    case '\r':
+    case '\n':
+    case ' ':
+    case ',':
+      break;
+    case ':':
+      if (depth == 1) {
+        (*size)++;
+      }
+      break;
+    default:
+      if (depth == 1 && !object) {
+        (*size)++;
+      }
+      if (c == '\"') {
+        r = jsmn_parse_string(parser, js, len, NULL, 0);
+#ifdef JSMN_STRICT
+      } else if (!jsmn_strict_primitive(c)) {
+        return JSMN_ERROR_INVAL;
+#endif
+      } else {
+        r = jsmn_parse_primitive(parser, js, len, NULL, 0);
+      }
+      if (r < 0) {
+        return r;
+      }
+      break;
+    }
+    parser->pos++;
+  } while (depth > 0);
+  return 0;
+}
+
+/**
+ * Compares an object key with a JSON Pointer reference token, where "~1"
+ * stands for '/' and "~0" for '~'.
+ */
+static int jsmn_key_eq(const char *js, jsmnint_t start, const jsmnint_t end,
+                       const char *ref, const char *ref_end) {
+  while (ref < ref_end) {
+    char c = *ref++;
+    if (c == '~' && ref < ref_end && (*ref == '0' || *ref == '1')) {
+      c = (*ref++ == '0' ? '~' : '/');
+    }
+    if (start >= end || js[start++] != c) {
+      return 0;
+    }
+  }
+  return start == end;
+}
+
+/**
+ * Moves the parser to the value of the given key of the object at the parser
+ * position. Returns 0 if there is no such key.
+ */
+static int jsmn_find_key(jsmn_parser *parser, const char *js, const size_t len,
+                         const char *ref, const char *ref_end) {
+  int r;
+  jsmnint_t start, end, size;
+  char c;
+
+  parser->pos++;
+  for (;;) {
+    c = jsmn_skip_ws(parser, js, len);
+    start = (jsmnint_t)parser->pos;
+    if (c == '}') {
+      return 0;
+    } else if (c == '\"') {
+      r = jsmn_parse_string(parser, js, len, NULL, 0);
+      start++;
+      end = (jsmnint_t)parser->pos;
+#ifdef JSMN_STRICT
+    } else if (c != '\0') {
+      /* In strict mode keys must be strings */
+      return JSMN_ERROR_INVAL;
+#endif
+    } else {
+      r = jsmn_parse_primitive(parser, js, len, NULL, 0);
+      end = (jsmnint_t)parser->pos + 1;
+    }
+    if (r < 0) {
+      return r;
+    }
+    parser->pos++;
+    c = jsmn_skip_ws(parser, js, len);
+    if (c != ':') {
+      return c == '\0' ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+    }
+    parser->pos++;
+    c = jsmn_skip_ws(parser, js, len);
+    if (c == '\0') {
+      return JSMN_ERROR_PART;
+    }
+    if (jsmn_key_eq(js, start, end, ref, ref_end)) {
+      return 1;
+    }
+    r = jsmn_skip_value(parser, js, len, &size);
+    if (r < 0) {
+      return r;
+    }
+    c = jsmn_skip_ws(parser, js, len);
+    if (c != ',') {
+      return c == '}' ? 0 : c == '\0' ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+    }
+    parser->pos++;
+  }
+}
+
+/**
+ * Moves the parser to the element with the given index of the array at the
+ * parser position. Returns 0 if there is no such element.
+ */
+static int jsmn_find_index(jsmn_parser *parser, const char *js,
+                           const size_t len, const char *ref,
+                           const char *ref_end) {
+  int r;
+  jsmnint_t size;
+  size_t i = 0;
+  char c;
+
+  /* An index has no leading zeros */
+  if (ref == ref_end || (*ref == '0' && ref_end - ref > 1)) {
+    return 0;
+  }
+  for (; ref < ref_end; ref++) {
+    /* "-" (the element after the last one) never exists */
+    if (*ref < '0' || *ref > '9') {
+      return 0;
+    }
+    /* Nor does an element past the end of the data, stop before i wraps */
+    if (i > len / 10) {
+      return 0;
+    }
+    i = i * 10 + (size_t)(*ref - '0');
+  }
+
+  parser->pos++;
+  for (;;) {
+    c = jsmn_skip_ws(parser, js, len);
+    if (c == ']') {
+      return 0;
+    } else if (c == '\0') {
+      return JSMN_ERROR_PART;
+    }
+    if (i-- == 0) {
+      return 1;
+    }
+    r = jsmn_skip_value(parser, js, len, &size);
+    if (r < 0) {
+      return r;
+    }
+    c = jsmn_skip_ws(parser, js, len);
+    if (c != ',') {
+      return c == ']' ? 0 : c == '\0' ? JSMN_ERROR_PART : JSMN_ERROR_INVAL;
+    }
+    parser->pos++;
+  }
+}
+
+/**
+ * Find a value by JSON Pointer.
+ */
+JSMN_API int jsmn_find_path(const char *js, const size_t len,
+                            const char *path, jsmntok_t *token) {
+  jsmn_parser parser;
+  const char *ref_end;
+  int r;
+  jsmnint_t size;
+  char c;
+
+  if (*path != '\0' && *path != '/') {
+    return JSMN_ERROR_INVAL;
+  }
+  jsmn_init(&parser);
+  for (;;) {
+    c = jsmn_skip_ws(&parser, js, len);
+    if (c == '\0') {
+      return JSMN_ERROR_PART;
+    }
+    if (*path == '\0') {
+      break;
+    }
+    for (ref_end = ++path; *ref_end != '\0' && *ref_end != '/'; ref_end++) {
+    }
+    if (c == '{') {
+      r = jsmn_find_key(&parser, js, len, path, ref_end);
+    } else if (c == '[') {
+      r = jsmn_find_index(&parser, js, len, path, ref_end);
+    } else {
+      r = 0;
+    }
+    if (r <= 0) {
+      return r;
+    }
+    path = ref_end;
+  }
+
+  /* The value has been found, parse it into the token */
+  if (c == '\"') {
+    r = jsmn_parse_string(&parser, js, len, token, 1);
+  } else if (c == '{' || c == '[') {
+    jsmn_fill_token(token, c == '{' ? JSMN_OBJECT : JSMN_ARRAY,
+                    (jsmnint_t)parser.pos, -1);
+    r = jsmn_skip_value(&parser, js, len, &size);
+    token->end = (jsmnint_t)parser.pos;
+    token->size = size;
+#ifdef JSMN_PARENT_LINKS
+    token->parent = -1;
+#endif
+#ifdef JSMN_SKIP_LINKS
+    token->next = 1;
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+    token->escaped = 0;
+#endif
+#ifdef JSMN_COMPACT
+    if (r >= 0 && size > JSMN_MAX_SIZE) {
+      r = JSMN_ERROR_RANGE;
+    }
+#endif
+#ifdef JSMN_STRICT
+  } else if (!jsmn_strict_primitive(c)) {
+    r = JSMN_ERROR_INVAL;
+#endif
+  } else {
+    r = jsmn_parse_primitive(&parser, js, len, token, 1);
+  }
+  return r < 0 ? r : 1;
+}
+
+/**
+ * Hashes key bytes with FNV-1a.
+ */
+static unsigned long jsmn_hash(const char *key, const size_t len) {
+  unsigned long h = 2166136261UL;
+  size_t i;
+  for (i = 0; i < len; i++) {
+    h = ((h ^ (unsigned char)key[i]) * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return h;
+}
+
+/**
+ * Finds the slot holding the given key, or the empty slot it would go to.
+ */
+static jsmnuint_t jsmn_index_slot(const jsmn_index *index, const char *js,
+                                  const jsmntok_t *tokens, const char *key,
+                                  const size_t key_len) {
+  jsmnuint_t mask = index->num_slots - 1;
+  jsmnuint_t i = (jsmnuint_t)jsmn_hash(key, key_len) & mask;
+  for (;; i = (i + 1) & mask) {
+    jsmnint_t k = index->slots[i];
+    size_t j;
+    if (k == -1) {
+      return i;
+    }
+    if ((size_t)(tokens[k].end - tokens[k].start) != key_len) {
+      continue;
+    }
+    for (j = 0; j < key_len && js[tokens[k].start + j] == key[j]; j++) {
+    }
+    if (j == key_len) {
+      return i;
+    }
+  }
+}
+
+/**
+ * Index keys of an object.
+ */
+JSMN_API int jsmn_index_init(jsmn_index *index, const char *js,
+                             const jsmntok_t *tokens, const jsmnint_t object,
+                             jsmnint_t *slots, const jsmnuint_t num_slots) {
+  jsmnuint_t i, n;
+  jsmnint_t k;
+
+  if (tokens[object].type != JSMN_OBJECT ||
+      (num_slots & (num_slots - 1)) != 0) {
+    return JSMN_ERROR_INVAL;
+  }
+  /* At least one slot must stay empty to end the probing */
+  if (num_slots <= (jsmnuint_t)tokens[object].size) {
+    return JSMN_ERROR_NOMEM;
+  }
+  index->object = object;
+  index->slots = slots;
+  index->num_slots = num_slots;
+  for (i = 0; i < num_slots; i++) {
+    slots[i] = -1;
+  }
+
+  k = object + 1;
+  for (n = 0; n < (jsmnuint_t)tokens[object].size; n++) {
+    i = jsmn_index_slot(index, js, tokens, js + tokens[k].start,
+                        (size_t)(tokens[k].end - tokens[k].start));
+    if (slots[i] == -1) {
+      slots[i] = k;
+    }
+    /* Skip the key and its value with everything nested in it */
+#ifdef JSMN_SKIP_LINKS
+    k = tokens[k + 1].next;
+#else
+    {
+      jsmnint_t left = 1;
+      for (k++; left > 0; k++) {
+        left += (jsmnint_t)tokens[k].size - 1;
+      }
+    }
+#endif
+  }
+  return 0;
+}
+
+/**
+ * Look up a key in an indexed object.
+ */
+JSMN_API jsmnint_t jsmn_index_find(const jsmn_index *index, const char *js,
+                                   const jsmntok_t *tokens, const char *key,
+                                   const size_t key_len) {
+  jsmnint_t k = index->slots[jsmn_index_slot(index, js, tokens, key, key_len)];
+  return k == -1 ? -1 : k + 1;
+}
+
+/**
+ * Checks a number token against the RFC 8259 grammar and tells whether it is
+ * an integer, i.e. has neither a fraction nor an exponent.
+ */
+static int jsmn_check_number(const char *js, const jsmntok_t *tok,
+                             int *integer) {
+  const char *p = js + tok->start;
+  const char *end = js + tok->end;
+
+  if (tok->type != JSMN_PRIMITIVE) {
+    return JSMN_ERROR_INVAL;
+  }
+  if (p < end && *p == '-') {
+    p++;
+  }
+  if (p < end && *p == '0') {
+    p++;
+  } else if (p < end && *p >= '1' && *p <= '9') {
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+    }
+  } else {
+    return JSMN_ERROR_INVAL;
+  }
+  *integer = 1;
+  if (p < end && *p == '.') {
+    if (++p == end || *p < '0' || *p > '9') {
+      return JSMN_ERROR_INVAL;
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    }
+    *integer = 0;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    if (++p < end && (*p == '+' || *p == '-')) {
+      p++;
+    }
+    if (p == end || *p < '0' || *p > '9') {
+      return JSMN_ERROR_INVAL;
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    }
+    *integer = 0;
+  }
+  return p == end ? 0 : JSMN_ERROR_INVAL;
+}
+
+/*
+ * Decimal numbers of up to 800 digits, enough to round any number to the
+ * nearest double exactly ("Simple Decimal Conversion" of Go's strconv
+ * package). Multiplying and dividing by powers of two brings the number
+ * into [0.5, 1), then the binary exponent and the mantissa are known.
+ * Numbers with more digits keep whether the digits dropped are all 0, which
+ * is all that rounding needs to know about them.
+ */
+#define JSMN_DECIMAL_DIGITS 800
+
+typedef struct jsmn_decimal {
+  unsigned char d[JSMN_DECIMAL_DIGITS]; /* digits 0 to 9, no trailing 0s */
+  int nd;                               /* number of digits */
+  int dp;    /* position of the decimal point, may be < 0 or > nd */
+  int trunc; /* non-zero digits were dropped */
+} jsmn_decimal;
+
+/**
+ * Drops trailing zeros.
+ */
+static void jsmn_decimal_trim(jsmn_decimal *a) {
+  while (a->nd > 0 && a->d[a->nd - 1] == 0) {
+    a->nd--;
+  }
+  if (a->nd == 0) {
+    a->dp = 0;
+  }
+}
+
+/**
+ * Multiplies a decimal by 2^k, 0 < k <= 28.
+ */
+static void jsmn_decimal_left(jsmn_decimal *a, const unsigned int k) {
+  unsigned long n = 0, carry;
+  int r, c = 0;
+
+  for (r = a->nd - 1; r >= 0; r--) {
+    n += (unsigned long)a->d[r] << k;
+    a->d[r] = (unsigned char)(n % 10);
+    n /= 10;
+  }
+  /* The carry becomes new leading digits, the last ones may drop out */
+  for (carry = n; carry > 0; carry /= 10) {
+    c++;
+  }
+  for (r = a->nd - 1; r >= 0; r--) {
+    if (r + c < JSMN_DECIMAL_DIGITS) {
+      a->d[r + c] = a->d[r];
+    } else if (a->d[r] != 0) {
+      a->trunc = 1;
+    }
+  }
+  for (r = c - 1; r >= 0; r--) {
+    a->d[r] = (unsigned char)(n % 10);
+    n /= 10;
+  }
+  a->nd = a->nd + c < JSMN_DECIMAL_DIGITS ? a->nd + c : JSMN_DECIMAL_DIGITS;
+  a->dp += c;
+  jsmn_decimal_trim(a);
+}
+
+/**
+ * Divides a decimal by 2^k, 0 < k <= 28.
+ */
+static void jsmn_decimal_right(jsmn_decimal *a, const unsigned int k) {
+  const unsigned long mask = ((unsigned long)1 << k) - 1;
+  unsigned long n = 0;
+  int r = 0, w = 0;
+
+  /* Digits that become leading zeros */
+  for (; (n >> k) == 0; r++) {
+    if (r >= a->nd) {
+      if (n == 0) {
+        a->nd = 0;
+        a->dp = 0;
+        return;
+      }
+      for (; (n >> k) == 0; r++) {
+        n *= 10;
+      }
+      break;
+    }
+    n = n * 10 + a->d[r];
+  }
+  a->dp -= r - 1;
+  for (; r < a->nd; r++) {
+    a->d[w++] = (unsigned char)(n >> k);
+    n = (n & mask) * 10 + a->d[r];
+  }
+  while (n > 0) {
+    if (w < JSMN_DECIMAL_DIGITS) {
+      a->d[w++] = (unsigned char)(n >> k);
+    } else if ((n >> k) != 0) {
+      a->trunc = 1;
+    }
+    n = (n & mask) * 10;
+  }
+  a->nd = w;
+  jsmn_decimal_trim(a);
+}
+
+/**
+ * Multiplies a decimal by 2^k, or divides it by 2^-k.
+ */
+static void jsmn_decimal_shift(jsmn_decimal *a, int k) {
+  for (; k > 28; k -= 28) {
+    jsmn_decimal_left(a, 28);
+  }
+  for (; k < -28; k += 28) {
+    jsmn_decimal_right(a, 28);
+  }
+  if (k > 0) {
+    jsmn_decimal_left(a, (unsigned int)k);
+  } else if (k < 0) {
+    jsmn_decimal_right(a, (unsigned int)-k);
+  }
+}
+
+/**
+ * Tells whether a decimal rounded to its first nd digits goes up, halfway
+ * cases to even.
+ */
+static int jsmn_decimal_round_up(const jsmn_decimal *a, const int nd) {
+  if (nd < 0 || nd >= a->nd) {
+    return 0;
+  }
+  if (a->d[nd] == 5 && nd + 1 == a->nd) {
+    return a->trunc || (nd > 0 && a->d[nd - 1] % 2 == 1);
+  }
+  return a->d[nd] >= 5;
+}
+
+/**
+ * Returns 2^e, exactly for -1074 <= e <= 1023.
+ */
+static double jsmn_pow2(const int e) {
+  unsigned int k = (unsigned int)(e < 0 ? -e : e);
+  double r = 1, b = e < 0 ? 0.5 : 2;
+
+  for (;;) {
+    if (k & 1) {
+      r *= b;
+    }
+    k >>= 1;
+    if (k == 0) {
+      return r;
+    }
+    b *= b;
+  }
+}
+
+/**
+ * Reads the digits of a number checked by jsmn_check_number(), without the
+ * sign, into a decimal.
+ */
+static void jsmn_decimal_read(jsmn_decimal *a, const char *p,
+                              const char *end) {
+  long dp = 0, e = 0;
+  int point = 0, neg;
+
+  a->nd = 0;
+  a->trunc = 0;
+  for (; p < end && *p != 'e' && *p != 'E'; p++) {
+    if (*p == '.') {
+      point = 1;
+    } else if (a->nd == 0 && *p == '0') {
+      dp -= point && dp > -100000;
+    } else {
+      if (a->nd < JSMN_DECIMAL_DIGITS) {
+        a->d[a->nd++] = (unsigned char)(*p - '0');
+      } else if (*p != '0') {
+        a->trunc = 1;
+      }
+      dp += !point && dp < 100000;
+    }
+  }
+  if (p < end) {
+    neg = (*++p == '-');
+    if (*p == '+' || *p == '-') {
+      p++;
+    }
+    for (; p < end; p++) {
+      if (e < 100000) {
+        e = e * 10 + (*p - '0');
+      }
+    }
+    dp += neg ? -e : e;
+  }
+  /* Anything beyond is 0 or too large anyway */
+  a->dp = (int)(dp < -1000 ? -1000 : dp > 1000 ? 1000 : dp);
+  jsmn_decimal_trim(a);
+}
+
+/**
+ * Rounds a decimal to the nearest double. Returns JSMN_ERROR_RANGE if it is
+ * too large, numbers too small to tell from 0 become 0.
+ */
+static int jsmn_decimal_to_double(jsmn_decimal *a, double *value) {
+  /* Shifts by which numbers of 1 to 8 digits stay at least 0.5 */
+  static const unsigned char steps[9] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+  double mant = 0;
+  int exp = 0, n, i;
+
+  if (a->nd == 0 || a->dp < -330) {
+    *value = 0;
+    return 0;
+  }
+  if (a->dp > 310) {
+    return JSMN_ERROR_RANGE;
+  }
+  while (a->dp > 0) {
+    n = a->dp >= 9 ? 27 : steps[a->dp];
+    jsmn_decimal_shift(a, -n);
+    exp += n;
+  }
+  while (a->dp < 0 || (a->dp == 0 && a->d[0] < 5)) {
+    n = -a->dp >= 9 ? 27 : steps[-a->dp];
+    jsmn_decimal_shift(a, n);
+    exp -= n;
+  }
+  /* Now in [0.5, 1) times 2^exp, i.e. [1, 2) times 2^(exp - 1) */
+  exp--;
+  if (exp < -1022) {
+    /* Subnormals have fewer bits */
+    jsmn_decimal_shift(a, exp + 1022);
+    exp = -1022;
+  }
+  if (exp > 1023) {
+    return JSMN_ERROR_RANGE;
+  }
+  jsmn_decimal_shift(a, 53);
+  for (i = 0; i < a->dp; i++) {
+    mant = mant * 10 + (i < a->nd ? a->d[i] : 0);
+  }
+  if (jsmn_decimal_round_up(a, a->dp)) {
+    mant++;
+  }
+  if (mant == 9007199254740992.0) {
+    mant /= 2;
+    if (++exp > 1023) {
+      return JSMN_ERROR_RANGE;
+    }
+  }
+  *value = mant * jsmn_pow2(exp - 52);
+  return 0;
+}
+
+#ifdef JSMN_HAS_INT64
+/*
+ * Powers of five to 125 bits, for conversions between doubles and decimal
+ * digits both ways. They are computed from every 26th one and 5^0..5^25 plus
+ * a correction of 0 to 3 per power, two bits each, instead of tables of all
+ * of them.
+ */
+static const uint64_t jsmn_pow5_small[26] = {
+    1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125,
+    244140625, 1220703125, 6103515625, 30517578125, 152587890625, 762939453125,
+    3814697265625, 19073486328125, 95367431640625, 476837158203125,
+    2384185791015625, 11920928955078125, 59604644775390625, 298023223876953125};
+
+/* 5^(26 i) scaled to 125 bits, low and high 64 bits */
+static const uint64_t jsmn_pow5_split[13][2] = {
+    {0x0000000000000000, 0x1000000000000000},
+    {0x0000000000000000, 0x14adf4b7320334b9},
+    {0x0e549208b31adb10, 0x1aba4714957d300d},
+    {0x6dc6ad264d8f0866, 0x1145b7e285bf98f5},
+    {0xeb1dbd923d8596ca, 0x1652efdc6018a1fc},
+    {0xb4c1b80b22ae923c, 0x1cda62055b2d9d83},
+    {0x5bb28b4e8f7e4c30, 0x12a5568b9f52f416},
+    {0xf08aed437682d4fb, 0x1819651531f9e78f},
+    {0xb4ee134ad99bf150, 0x1f25c186a6f04c28},
+    {0x16499ecb70c25f03, 0x1420eb449c8842e6},
+    {0x85a56ead360865b0, 0x1a03fde214caf085},
+    {0x093db1d57999890b, 0x10cfeb353a97dad8},
+    {0xcf38bb735e3f36ac, 0x15baaf44fa52673e}};
+
+/* 5^-(26 i) scaled to 125 bits and rounded up */
+static const uint64_t jsmn_pow5_inv_split[15][2] = {
+    {0x0000000000000001, 0x2000000000000000},
+    {0x52a6c95fc0655034, 0x18c240c4aecb13bb},
+    {0x7ca8d50071dfc806, 0x1327fc58da0f6ff5},
+    {0x6520247d3556476e, 0x1da48ce468e7c702},
+    {0x6139cdd76802e6e9, 0x16ef5b40c2fc7779},
+    {0xf951a7ff43de8c79, 0x11bebdf578b2f391},
+    {0x7be8bee8d6e957e8, 0x1b758d848fac54b0},
+    {0x8bd3f9e999a423ea, 0x153eda614071a3b7},
+    {0x0848f973cb3ee3ce, 0x10701bd527b4978c},
+    {0x153285ebb9efbfa2, 0x196fbb9bb44db44d},
+    {0xadeee7f86c07b696, 0x13ae3591f5b4d936},
+    {0x4d686a4eaf182222, 0x1e74404f3daada91},
+    {0x98c0a106e09ebd9f, 0x17900ea4fda7c257},
+    {0x8f20e37371497d0e, 0x123b140576d820b2},
+    {0xb043138134743d85, 0x1c35f4275f7a29ad}};
+
+static const uint32_t jsmn_pow5_offsets[21] = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x40000000, 0x59695995,
+    0x55545555, 0x56555515, 0x41150504, 0x40555410, 0x44555145, 0x44504540,
+    0x45555550, 0x40004000, 0x96440440, 0x55565565, 0x54454045, 0x40154151,
+    0x55559155, 0x51405555, 0x00000105};
+
+static const uint32_t jsmn_pow5_inv_offsets[22] = {
+    0x54544554, 0x04055545, 0x10041000, 0x00400414, 0x40010000, 0x41155555,
+    0x00000454, 0x00010044, 0x40000000, 0x44000041, 0x50454450, 0x55550054,
+    0x51655554, 0x40004000, 0x01000001, 0x00010500, 0x51515411, 0x05555554,
+    0x50411500, 0x40040000, 0x05040110, 0x40000000};
+
+/**
+ * Returns the low 64 bits of a * b and stores the high ones.
+ */
+static uint64_t jsmn_umul128(const uint64_t a, const uint64_t b,
+                             uint64_t *high) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 jsmn_uint128;
+  jsmn_uint128 p = (jsmn_uint128)a * b;
+  *high = (uint64_t)(p >> 64);
+  return (uint64_t)p;
+#else
+  const uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32;
+  const uint64_t b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+  const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0;
+  const uint64_t mid = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+  *high = a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return (mid << 32) | (p00 & 0xFFFFFFFF);
+#endif
+}
+
+/**
+ * Returns bits 64 + shift .. 127 + shift of the 192-bit product of m and mul,
+ * 0 < shift < 64.
+ */
+static uint64_t jsmn_mul_shift(const uint64_t m, const uint64_t *mul,
+                               const int shift) {
+  uint64_t high0, high1, low1, sum;
+
+  jsmn_umul128(m, mul[0], &high0);
+  low1 = jsmn_umul128(m, mul[1], &high1);
+  sum = high0 + low1;
+  if (sum < high0) {
+    high1++;
+  }
+  return (high1 << (64 - shift)) | (sum >> shift);
+}
+
+/**
+ * Multiplies a small power of five with a 125-bit table entry and shifts the
+ * 192-bit product right into 128 bits.
+ */
+static void jsmn_pow5_scale(const uint64_t m, const uint64_t *mul,
+                            const uint64_t low, const unsigned int shift,
+                            uint64_t *result) {
+  uint64_t high0, high1, low0, low1, sum;
+
+  low0 = jsmn_umul128(m, low, &high0);
+  low1 = jsmn_umul128(m, mul[1], &high1);
+  sum = high0 + low1;
+  if (sum < high0) {
+    high1++;
+  }
+  result[0] = (sum << (64 - shift)) | (low0 >> shift);
+  result[1] = (high1 << (64 - shift)) | (sum >> shift);
+}
+
+/**
+ * Number of bits of 5^e, for 0 < e <= 3528.
+ */
+static int jsmn_pow5_bits(const int e) {
+  return (int)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+/**
+ * 5^i scaled to 125 bits.
+ */
+static void jsmn_pow5(const int i, uint64_t *result) {
+  const int base = i / 26;
+  const int offset = i - base * 26;
+
+  if (offset == 0) {
+    result[0] = jsmn_pow5_split[base][0];
+    result[1] = jsmn_pow5_split[base][1];
+    return;
+  }
+  jsmn_pow5_scale(jsmn_pow5_small[offset], jsmn_pow5_split[base],
+                  jsmn_pow5_split[base][0],
+                  (unsigned int)(jsmn_pow5_bits(i) -
+                                 jsmn_pow5_bits(base * 26)),
+                  result);
+  result[0] += (jsmn_pow5_offsets[i / 16] >> ((i % 16) * 2)) & 3;
+}
+
+/**
+ * 5^-i scaled to 125 bits and rounded up.
+ */
+static void jsmn_pow5_inv(const int i, uint64_t *result) {
+  const int base = (i + 25) / 26;
+  const int offset = base * 26 - i;
+
+  if (offset == 0) {
+    result[0] = jsmn_pow5_inv_split[base][0];
+    result[1] = jsmn_pow5_inv_split[base][1];
+    return;
+  }
+  jsmn_pow5_scale(jsmn_pow5_small[offset], jsmn_pow5_inv_split[base],
+                  jsmn_pow5_inv_split[base][0] - 1,
+                  (unsigned int)(jsmn_pow5_bits(base * 26) -
+                                 jsmn_pow5_bits(i)),
+                  result);
+  result[0] += 1 + ((jsmn_pow5_inv_offsets[i / 16] >> ((i % 16) * 2)) & 3);
+}
+
+/**
+ * Converts w times 10^q to the nearest normal double with a 125-bit power of
+ * five, accurate to less than one in 2^64 of w. Returns 0, or 1 if that is
+ * too close to halfway between two doubles to tell, or the double would not
+ * be normal.
+ */
+static int jsmn_mul_pow10(uint64_t w, const int q, double *value) {
+  uint64_t pow5[2], high0, high1, low1, p1, p2, m, low, half;
+  int lz = 0, e, shift;
+
+  if (w == 0 || q < -342 || q > 335) {
+    return 1;
+  }
+  for (; (w >> 63) == 0; lz++) {
+    w <<= 1;
+  }
+  if (q >= 0) {
+    jsmn_pow5(q, pow5);
+    e = q + jsmn_pow5_bits(q) - 125 - lz;
+  } else {
+    jsmn_pow5_inv(-q, pow5);
+    e = q - jsmn_pow5_bits(-q) - 124 - lz;
+  }
+  /* The upper 128 of the 189 or 190 bits of the product */
+  jsmn_umul128(w, pow5[0], &high0);
+  low1 = jsmn_umul128(w, pow5[1], &high1);
+  p1 = high0 + low1;
+  p2 = high1 + (p1 < high0);
+  shift = (p2 >> 60) != 0 ? 8 : 7;
+  m = p2 >> shift;
+  low = p2 & (((uint64_t)1 << shift) - 1);
+  half = (uint64_t)1 << (shift - 1);
+  /* The product is off by less than one in p1, so it may be exactly half */
+  if ((low == half && p1 <= 1) || (low == half - 1 && p1 == ~(uint64_t)0)) {
+    return 1;
+  }
+  m += low >= half;
+  e += 128 + shift;
+  if ((m >> 53) != 0) {
+    m >>= 1;
+    e++;
+  }
+  if (e < -1022 - 52 || e > 1023 - 52) {
+    return 1;
+  }
+  *value = (double)m * jsmn_pow2(e);
+  return 0;
+}
+
+#endif /* JSMN_HAS_INT64 */
+
+/**
+ * Converts the digits of a number checked by jsmn_check_number(), without the
+ * sign, to the nearest double. With 64-bit integers the first 19 significant
+ * digits mostly tell, if they and the digits after them round the same way;
+ * otherwise the number is rounded exactly as a decimal.
+ */
+static int jsmn_parse_double(const char *p, const char *end, double *value) {
+  jsmn_decimal a;
+#ifdef JSMN_HAS_INT64
+  const char *s = p;
+  uint64_t w = 0;
+  long q = 0, e = 0;
+  int digits = 0, point = 0, trunc = 0, neg;
+  double v, v1;
+
+  for (; s < end && *s != 'e' && *s != 'E'; s++) {
+    if (*s == '.') {
+      point = 1;
+    } else if (w == 0 && *s == '0') {
+      q -= point;
+    } else if (digits < 19) {
+      w = w * 10 + (unsigned int)(*s - '0');
+      digits++;
+      q -= point;
+    } else {
+      trunc |= *s != '0';
+      q += !point;
+    }
+  }
+  if (s < end) {
+    neg = (*++s == '-');
+    if (*s == '+' || *s == '-') {
+      s++;
+    }
+    for (; s < end; s++) {
+      if (e < 100000) {
+        e = e * 10 + (*s - '0');
+      }
+    }
+    q += neg ? -e : e;
+  }
+  if (q >= -400 && q <= 400 && jsmn_mul_pow10(w, (int)q, &v) == 0 &&
+      (!trunc || (jsmn_mul_pow10(w + 1, (int)q, &v1) == 0 && v1 == v))) {
+    *value = v;
+    return 0;
+  }
+#endif
+  jsmn_decimal_read(&a, p, end);
+  return jsmn_decimal_to_double(&a, value);
+}
+
+/**
+ * Convert a number token to double. Up to 15 significant digits are exact in
+ * a double, and so are powers of ten up to 1e22, so a single multiplication or
+ * division of the two is correctly rounded. Other numbers take the longer
+ * way of jsmn_parse_double(), which doesn't depend on the locale either.
+ */
+JSMN_API int jsmn_tok_to_double(const char *js, const jsmntok_t *tok,
+                                double *value) {
+  static const double pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p = js + tok->start;
+  const char *end = js + tok->end;
+  double m = 0;
+  int digits = 0;
+  long e = 0;
+  long exp10 = 0;
+  int neg, integer, r;
+
+  r = jsmn_check_number(js, tok, &integer);
+  if (r < 0) {
+    return r;
+  }
+  neg = (*p == '-');
+  if (neg) {
+    p++;
+  }
+  for (; p < end && *p != 'e' && *p != 'E'; p++) {
+    if (*p == '.') {
+      e = -1;
+      continue;
+    }
+    if (m != 0 || *p != '0') {
+      if (++digits > 15) {
+        goto slow;
+      }
+      m = m * 10 + (*p - '0');
+    }
+    exp10 += e;
+  }
+  if (p < end) {
+    int eneg = (*++p == '-');
+    if (*p == '+' || *p == '-') {
+      p++;
+    }
+    for (e = 0; p < end; p++) {
+      if (e < 100000) {
+        e = e * 10 + (*p - '0');
+      }
+    }
+    exp10 += eneg ? -e : e;
+  }
+
+  if (m == 0) {
+    *value = neg ? -0.0 : 0.0;
+    return 0;
+  }
+  if (exp10 >= -22 && exp10 <= 22) {
+    m = exp10 < 0 ? m / pow10[-exp10] : m * pow10[exp10];
+  } else if (exp10 > 22 && exp10 <= 22 + 15 - digits) {
+    /* 123e30 is 123000000000000e16, still exact */
+    m = m * pow10[exp10 - 22] * pow10[22];
+  } else {
+    goto slow;
+  }
+  *value = neg ? -m : m;
+  return 0;
+
+slow:
+  r = jsmn_parse_double(js + tok->start + neg, end, &m);
+  if (r == 0) {
+    *value = neg ? -m : m;
+  }
+  return r;
+}
+
+/**
+ * Convert all elements of an array of numbers to double.
+ */
+JSMN_API jsmnint_t jsmn_array_to_double(const char *js,
+                                        const jsmntok_t *tokens,
+                                        const jsmnint_t array, double *values,
+                                        const jsmnuint_t num_values) {
+  jsmnint_t i;
+  int r;
+
+  if (tokens[array].type != JSMN_ARRAY) {
+    return JSMN_ERROR_INVAL;
+  }
+  if ((jsmnuint_t)tokens[array].size > num_values) {
+    return JSMN_ERROR_NOMEM;
+  }
+  /* Numbers have no children, so the elements follow the array token */
+  for (i = 0; i < (jsmnint_t)tokens[array].size; i++) {
+    r = jsmn_tok_to_double(js, &tokens[array + 1 + i], &values[i]);
+    if (r < 0) {
+      return r;
+    }
+  }
+  return i;
+}
+
+#ifdef JSMN_HAS_INT64
+/**
+ * Accumulates the digits of an integer token, failing if the absolute value
+ * exceeds the limit.
+ */
+static int jsmn_tok_to_digits(const char *js, const jsmntok_t *tok,
+                              const uint64_t limit, int *neg,
+                              uint64_t *value) {
+  const char *p = js + tok->start;
+  const char *end = js + tok->end;
+  uint64_t n = 0;
+  int integer;
+  int r = jsmn_check_number(js, tok, &integer);
+
+  if (r < 0 || !integer) {
+    return JSMN_ERROR_INVAL;
+  }
+  *neg = (*p == '-');
+  if (*neg) {
+    p++;
+  }
+  for (; p < end; p++) {
+    unsigned int d = (unsigned int)(*p - '0');
+    if (n > (limit - d) / 10) {
+      return JSMN_ERROR_RANGE;
+    }
+    n = n * 10 + d;
+  }
+  *value = n;
+  return 0;
+}
+
+/**
+ * Convert an integer token to int64_t.
+ */
+JSMN_API int jsmn_tok_to_int64(const char *js, const jsmntok_t *tok,
+                               int64_t *value) {
+  const uint64_t max = (uint64_t)-1 >> 1;
+  uint64_t n;
+  int neg;
+  int r = jsmn_tok_to_digits(js, tok, max + 1, &neg, &n);
+
+  if (r < 0) {
+    return r;
+  }
+  if (neg) {
+    *value = n == 0 ? 0 : -(int64_t)(n - 1) - 1;
+  } else if (n > max) {
+    return JSMN_ERROR_RANGE;
+  } else {
+    *value = (int64_t)n;
+  }
+  return 0;
+}
+
+/**
+ * Convert an integer token to uint64_t.
+ */
+JSMN_API int jsmn_tok_to_uint64(const char *js, const jsmntok_t *tok,
+                                uint64_t *value) {
+  uint64_t n;
+  int neg;
+  int r = jsmn_tok_to_digits(js, tok, (uint64_t)-1, &neg, &n);
+
+  if (r < 0) {
+    return r;
+  }
+  if (neg && n != 0) {
+    return JSMN_ERROR_RANGE;
+  }
+  *value = n;
+  return 0;
+}
+
+/**
+ * Convert all elements of an array of integers to int64_t.
+ */
+JSMN_API jsmnint_t jsmn_array_to_int64(const char *js,
+                                       const jsmntok_t *tokens,
+                                       const jsmnint_t array, int64_t *values,
+                                       const jsmnuint_t num_values) {
+  jsmnint_t i;
+  int r;
+
+  if (tokens[array].type != JSMN_ARRAY) {
+    return JSMN_ERROR_INVAL;
+  }
+  if ((jsmnuint_t)tokens[array].size > num_values) {
+    return JSMN_ERROR_NOMEM;
+  }
+  for (i = 0; i < (jsmnint_t)tokens[array].size; i++) {
+    r = jsmn_tok_to_int64(js, &tokens[array + 1 + i], &values[i]);
+    if (r < 0) {
+      return r;
+    }
+  }
+  return i;
+}
+#endif /* JSMN_HAS_INT64 */
+
+/**
+ * Reads four hex digits of a \uXXXX escape, returns -1 if they are missing.
+ */
+static long jsmn_hex4(const char *p, const char *end) {
+  long v = 0;
+  int i;
+  if (end - p < 4) {
+    return -1;
+  }
+  for (i = 0; i < 4; i++) {
+    char c = p[i];
+    if (c >= '0' && c <= '9') {
+      v = v * 16 + (c - '0');
+    } else if (c >= 'A' && c <= 'F') {
+      v = v * 16 + (c - 'A' + 10);
+    } else if (c >= 'a' && c <= 'f') {
+      v = v * 16 + (c - 'a' + 10);
+    } else {
+      return -1;
+    }
+  }
+  return v;
+}
+
+/**
+ * Decode escape sequences of a string token. The decoded string is never
+ * longer than the token, so it can be written over the token in place.
+ */
+JSMN_API jsmnint_t jsmn_unescape(const char *js, const jsmntok_t *tok,
+                                 char *out, const size_t out_len) {
+  const char *p = js + tok->start;
+  const char *end = js + tok->end;
+  size_t n = 0;
+
+  if (tok->type != JSMN_STRING) {
+    return JSMN_ERROR_INVAL;
+  }
+  while (p < end) {
+    char buf[4];
+    size_t k, size = 1;
+    long cp;
+
+#ifdef JSMN_SIMD_SSE2
+    /* Copy runs without backslashes 16 bytes at a time. Only whole blocks are
+     * stored, so decoding in place never overwrites unread input. */
+    if (out_len - n >= (size_t)(end - p)) {
+      const __m128i bslash = _mm_set1_epi8('\\');
+      while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash)) != 0) {
+          break;
+        }
+        _mm_storeu_si128((__m128i *)(out + n), v);
+        p += 16;
+        n += 16;
+      }
+    }
+    if (p == end) {
+      break;
+    }
+#endif
+    if (*p != '\\') {
+      buf[0] = *p++;
+    } else if (end - p < 2) {
+      return JSMN_ERROR_INVAL;
+    } else {
+      p += 2;
+      switch (p[-1]) {
+      case '\"':
+      case '/':
+      case '\\':
+        buf[0] = p[-1];
+        break;
+      case 'b':
+        buf[0] = '\b';
+        break;
+      case 'f':
+        buf[0] = '\f';
+        break;
+      case 'r':
+        buf[0] = '\r';
+        break;
+      case 'n':
+        buf[0] = '\n';
+        break;
+      case 't':
+        buf[0] = '\t';
+        break;
+      case 'u':
+        cp = jsmn_hex4(p, end);
+        if (cp < 0 || (cp >= 0xDC00 && cp <= 0xDFFF)) {
+          return JSMN_ERROR_INVAL;
+        }
+        p += 4;
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          /* High surrogate, must be followed by a low one */
+          long lo = end - p >= 6 && p[0] == '\\' && p[1] == 'u'
+                        ? jsmn_hex4(p + 2, end)
+                        : -1;
+          if (lo < 0xDC00 || lo > 0xDFFF) {
+            return JSMN_ERROR_INVAL;
+          }
+          p += 6;
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        }
+        /* Encode as UTF-8 */
+        if (cp < 0x80) {
+          buf[0] = (char)cp;
+        } else if (cp < 0x800) {
+          buf[0] = (char)(0xC0 | (cp >> 6));
+          buf[1] = (char)(0x80 | (cp & 0x3F));
+          size = 2;
+        } else if (cp < 0x10000) {
+          buf[0] = (char)(0xE0 | (cp >> 12));
+          buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+          buf[2] = (char)(0x80 | (cp & 0x3F));
+          size = 3;
+        } else {
+          buf[0] = (char)(0xF0 | (cp >> 18));
+          buf[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+          buf[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+          buf[3] = (char)(0x80 | (cp & 0x3F));
+          size = 4;
+        }
+        break;
+      default:
+        return JSMN_ERROR_INVAL;
+      }
+    }
+    if (out_len - n < size) {
+      return JSMN_ERROR_NOMEM;
+    }
+    for (k = 0; k < size; k++) {
+      out[n++] = buf[k];
+    }
+  }
+  return (jsmnint_t)n;
+}
+
+/**
+ * Grows the buffer of a writer to make room for n more bytes.
+ */
+static int jsmn_writer_grow(jsmn_writer *writer, const size_t n) {
+  size_t size;
+  void *p;
+
+  if (writer->grow == NULL || writer->len + n < n) {
+    return writer->error = JSMN_ERROR_NOMEM;
+  }
+  size = writer->size < 32 ? 64 : writer->size * 2;
+  if (size < writer->len + n) {
+    size = writer->len + n;
+  }
+  p = writer->grow(writer->user, writer->buf, size);
+  if (p == NULL) {
+    return writer->error = JSMN_ERROR_NOMEM;
+  }
+  writer->buf = (char *)p;
+  writer->size = size;
+  return 0;
+}
+
+/**
+ * Makes room for n more bytes in the buffer of a writer.
+ */
+JSMN_INLINE int jsmn_writer_reserve(jsmn_writer *writer, const size_t n) {
+  if (writer->size - writer->len >= n) {
+    return 0;
+  }
+  return jsmn_writer_grow(writer, n);
+}
+
+/**
+ * Starts a key or a value, making room for a comma and n bytes after it.
+ */
+JSMN_INLINE int jsmn_writer_start(jsmn_writer *writer, const size_t n) {
+  if (writer->error != 0 || jsmn_writer_reserve(writer, n + 1) < 0) {
+    return writer->error;
+  }
+  if (writer->comma) {
+    writer->buf[writer->len++] = ',';
+  }
+  return 0;
+}
+
+/**
+ * Writes a value of n bytes as they are.
+ */
+static int jsmn_writer_value(jsmn_writer *writer, const char *s,
+                             const size_t n) {
+  char *out;
+  size_t i;
+
+  if (jsmn_writer_start(writer, n) < 0) {
+    return writer->error;
+  }
+  out = writer->buf + writer->len;
+  for (i = 0; i < n; i++) {
+    out[i] = s[i];
+  }
+  writer->len += n;
+  writer->comma = 1;
+  return 0;
+}
+
+/**
+ * Copies the bytes at the start of a string that need no escaping and returns
+ * how many there are. Vectors are stored before they are checked, so the
+ * output needs room for all of the string.
+ */
+static size_t jsmn_copy_plain_chars(char *out, const char *s,
+                                    const size_t len) {
+  size_t n = 0;
+
+#if defined(JSMN_SIMD_AVX2)
+  {
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    for (; n + 32 <= len; n += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i *)(s + n));
+      unsigned int mask;
+      _mm256_storeu_si256((__m256i *)(out + n), v);
+      mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                          _mm256_cmpeq_epi8(v, bslash)),
+          _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl), ctrl)));
+      if (mask != 0) {
+        return n + jsmn_ctz(mask);
+      }
+    }
+  }
+#endif
+#ifdef JSMN_SIMD_SSE2
+  {
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    for (; n + 16 <= len; n += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i *)(s + n));
+      unsigned int mask;
+      _mm_storeu_si128((__m128i *)(out + n), v);
+      /* Bytes up to 0x1F are the ones max(v, 0x1F) leaves at 0x1F */
+      mask = (unsigned int)_mm_movemask_epi8(
+          _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                    _mm_cmpeq_epi8(v, bslash)),
+                       _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl)));
+      if (mask != 0) {
+        return n + jsmn_ctz(mask);
+      }
+    }
+  }
+#endif
+  for (; n < len; n++) {
+    unsigned char c = (unsigned char)s[n];
+    if (c < 0x20 || c == '\"' || c == '\\') {
+      break;
+    }
+    out[n] = (char)c;
+  }
+  return n;
+}
+
+/**
+ * Writes a string in quotes, followed by a colon if it is a key. Runs of
+ * characters that need no escaping are copied as they are found.
+ */
+static int jsmn_writer_quoted(jsmn_writer *writer, const char *s,
+                              const size_t len, const int key) {
+  static const char hex[] = "0123456789abcdef";
+  size_t i = 0;
+  char *out;
+
+  /* There is always room for the rest of the string, the closing quote and
+   * the colon, escapes make more */
+  if (jsmn_writer_start(writer, len + 2 + (key != 0)) < 0) {
+    return writer->error;
+  }
+  writer->buf[writer->len++] = '\"';
+  for (;;) {
+    size_t n = jsmn_copy_plain_chars(writer->buf + writer->len, s + i,
+                                     len - i);
+    writer->len += n;
+    i += n;
+    if (i == len) {
+      break;
+    }
+    if (jsmn_writer_reserve(writer, len - i + 6 + (key != 0)) < 0) {
+      return writer->error;
+    }
+    out = writer->buf + writer->len;
+    out[0] = '\\';
+    switch (s[i]) {
+    case '\"':
+    case '\\':
+      out[1] = s[i];
+      break;
+    case '\b':
+      out[1] = 'b';
+      break;
+    case '\f':
+      out[1] = 'f';
+      break;
+    case '\n':
+      out[1] = 'n';
+      break;
+    case '\r':
+      out[1] = 'r';
+      break;
+    case '\t':
+      out[1] = 't';
+      break;
+    default:
+      out[1] = 'u';
+      out[2] = '0';
+      out[3] = '0';
+      out[4] = hex[(unsigned char)s[i] >> 4];
+      out[5] = hex[s[i] & 0xF];
+      writer->len += 4;
+      break;
+    }
+    writer->len += 2;
+    i++;
+  }
+  writer->buf[writer->len++] = '\"';
+  if (key) {
+    writer->buf[writer->len++] = ':';
+  }
+  writer->comma = !key;
+  return 0;
+}
+
+/**
+ * Formats the decimal digits d[0..n) with the decimal point after digit k
+ * like JavaScript does: without an exponent from 1e-7 to 1e21, with one
+ * outside. Writes at most 25 bytes.
+ */
+static size_t jsmn_format_decimal(char *out, const int neg, const char *d,
+                                  const int n, const int k) {
+  char *p = out;
+  int i, e;
+
+  if (neg) {
+    *p++ = '-';
+  }
+  if (n <= k && k <= 21) {
+    for (i = 0; i < n; i++) {
+      *p++ = d[i];
+    }
+    for (; i < k; i++) {
+      *p++ = '0';
+    }
+  } else if (k > 0 && k <= 21) {
+    for (i = 0; i < n; i++) {
+      if (i == k) {
+        *p++ = '.';
+      }
+      *p++ = d[i];
+    }
+  } else if (k > -6 && k <= 0) {
+    *p++ = '0';
+    *p++ = '.';
+    for (i = k; i < 0; i++) {
+      *p++ = '0';
+    }
+    for (i = 0; i < n; i++) {
+      *p++ = d[i];
+    }
+  } else {
+    *p++ = d[0];
+    if (n > 1) {
+      *p++ = '.';
+      for (i = 1; i < n; i++) {
+        *p++ = d[i];
+      }
+    }
+    e = k - 1;
+    *p++ = 'e';
+    *p++ = e < 0 ? '-' : '+';
+    e = e < 0 ? -e : e;
+    if (e >= 100) {
+      *p++ = (char)('0' + e / 100);
+    }
+    if (e >= 10) {
+      *p++ = (char)('0' + e / 10 % 10);
+    }
+    *p++ = (char)('0' + e % 10);
+  }
+  return (size_t)(p - out);
+}
+
+#ifdef JSMN_HAS_INT64
+static const char jsmn_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+/**
+ * Writes the decimal digits of n two at a time, ending just before end.
+ * Returns where they start.
+ */
+static char *jsmn_format_digits(char *end, uint64_t n) {
+  unsigned int r;
+
+  while (n >= 100) {
+    r = (unsigned int)(n % 100) * 2;
+    n /= 100;
+    *--end = jsmn_digit_pairs[r + 1];
+    *--end = jsmn_digit_pairs[r];
+  }
+  if (n >= 10) {
+    r = (unsigned int)n * 2;
+    *--end = jsmn_digit_pairs[r + 1];
+    *--end = jsmn_digit_pairs[r];
+  } else {
+    *--end = (char)('0' + n);
+  }
+  return end;
+}
+
+/**
+ * Writes an integer, at most 21 bytes, and returns its length.
+ */
+static size_t jsmn_format_integer(char *out, const int neg, const uint64_t n) {
+  char buf[24];
+  char *d = jsmn_format_digits(buf + sizeof(buf), n);
+  size_t i, len;
+
+  if (neg) {
+    *--d = '-';
+  }
+  len = (size_t)(buf + sizeof(buf) - d);
+  for (i = 0; i < len; i++) {
+    out[i] = d[i];
+  }
+  return len;
+}
+
+/*
+ * Shortest round-trip digits of doubles with the Ryu algorithm (Ulf Adams,
+ * "Ryu: fast float-to-string conversion", PLDI 2018). It multiplies the
+ * bounds of the interval of numbers that read back as the double by a
+ * 125-bit approximation of a power of five and drops digits while they
+ * stay apart.
+ */
+
+/**
+ * Returns how many times 5 divides a non-zero value.
+ */
+static int jsmn_pow5_factor(uint64_t value) {
+  int n = 0;
+
+  while (value % 5 == 0) {
+    value /= 5;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * Finds the shortest digits of the finite, non-zero double with the given
+ * mantissa and biased exponent bits. Returns them and stores the power of
+ * ten they are multiplied by.
+ */
+static uint64_t jsmn_ryu(const uint64_t ieee_mantissa,
+                         const unsigned int ieee_exponent, int *exp10) {
+  uint64_t m2, mv, vr, vp, vm, vr10, pow5[2];
+  unsigned int mm_shift, last = 0;
+  int e2, q, even, vm_zeros = 0, vr_zeros = 0, round_up = 0;
+
+  if (ieee_exponent == 0) {
+    e2 = 1 - 1023 - 52 - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = (int)ieee_exponent - 1023 - 52 - 2;
+    m2 = ((uint64_t)1 << 52) | ieee_mantissa;
+  }
+  even = (m2 & 1) == 0;
+  /* The interval is (4 m2 - 1 - mm_shift, 4 m2 + 2) times 2^e2, narrower
+   * below a power of two */
+  mv = 4 * m2;
+  mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+  if (e2 >= 0) {
+    /* q = floor(log10(2^e2)), one less to keep a digit for rounding */
+    q = (int)(((uint32_t)e2 * 78913) >> 18) - (e2 > 3);
+    *exp10 = q;
+    jsmn_pow5_inv(q, pow5);
+    e2 = -e2 + q + 125 + jsmn_pow5_bits(q) - 1 - 64;
+    vr = jsmn_mul_shift(mv, pow5, e2);
+    vp = jsmn_mul_shift(mv + 2, pow5, e2);
+    vm = jsmn_mul_shift(mv - 1 - mm_shift, pow5, e2);
+    if (q <= 21) {
+      /* Only these can be exact multiples of 10^q */
+      if (mv % 5 == 0) {
+        vr_zeros = jsmn_pow5_factor(mv) >= q;
+      } else if (even) {
+        vm_zeros = jsmn_pow5_factor(mv - 1 - mm_shift) >= q;
+      } else {
+        vp -= jsmn_pow5_factor(mv + 2) >= q;
+      }
+    }
+  } else {
+    q = (int)(((uint32_t)-e2 * 732923) >> 20) - (-e2 > 1);
+    *exp10 = q + e2;
+    jsmn_pow5(-e2 - q, pow5);
+    e2 = q - (jsmn_pow5_bits(-e2 - q) - 125) - 64;
+    vr = jsmn_mul_shift(mv, pow5, e2);
+    vp = jsmn_mul_shift(mv + 2, pow5, e2);
+    vm = jsmn_mul_shift(mv - 1 - mm_shift, pow5, e2);
+    if (q <= 1) {
+      vr_zeros = 1;
+      if (even) {
+        vm_zeros = mm_shift == 1;
+      } else {
+        vp--;
+      }
+    } else if (q < 63) {
+      vr_zeros = (mv & (((uint64_t)1 << q) - 1)) == 0;
+    }
+  }
+
+  if (vm_zeros || vr_zeros) {
+    /* Rare: the bounds or the value are exact, so trailing zeros decide */
+    while (vp / 10 > vm / 10) {
+      vm_zeros &= vm % 10 == 0;
+      vr_zeros &= last == 0;
+      vr10 = vr / 10;
+      last = (unsigned int)(vr - vr10 * 10);
+      vr = vr10;
+      vp /= 10;
+      vm /= 10;
+      (*exp10)++;
+    }
+    if (vm_zeros) {
+      while (vm % 10 == 0) {
+        vr_zeros &= last == 0;
+        vr10 = vr / 10;
+        last = (unsigned int)(vr - vr10 * 10);
+        vr = vr10;
+        vp /= 10;
+        vm /= 10;
+        (*exp10)++;
+      }
+    }
+    if (vr_zeros && last == 5 && vr % 2 == 0) {
+      /* Exactly halfway, round to even */
+      last = 4;
+    }
+    return vr + ((vr == vm && (!even || !vm_zeros)) || last >= 5);
+  }
+  if (vp / 100 > vm / 100) {
+    vr10 = vr / 100;
+    round_up = vr - vr10 * 100 >= 50;
+    vr = vr10;
+    vp /= 100;
+    vm /= 100;
+    *exp10 += 2;
+  }
+  while (vp / 10 > vm / 10) {
+    vr10 = vr / 10;
+    round_up = vr - vr10 * 10 >= 5;
+    vr = vr10;
+    vp /= 10;
+    vm /= 10;
+    (*exp10)++;
+  }
+  return vr + (vr == vm || round_up);
+}
+
+/**
+ * Formats a finite double, writes at most 25 bytes.
+ */
+static size_t jsmn_format_double(char *out, const double value) {
+  union {
+    double d;
+    uint64_t u;
+  } u;
+  uint64_t bits, digits;
+  unsigned int exponent;
+  int exp10;
+  char buf[20];
+  char *d;
+
+  /* Integers below 2^53 are their own shortest digits */
+  if (value > -9007199254740992.0 && value < 9007199254740992.0 &&
+      value != 0 && value == (double)(int64_t)value) {
+    return jsmn_format_integer(out, value < 0,
+                               (uint64_t)(value < 0 ? -value : value));
+  }
+  u.d = value;
+  bits = u.u;
+  exponent = (unsigned int)(bits >> 52) & 0x7FF;
+  if (exponent == 0 && (bits & (((uint64_t)1 << 52) - 1)) == 0) {
+    digits = 0;
+    exp10 = 0;
+  } else {
+    digits = jsmn_ryu(bits & (((uint64_t)1 << 52) - 1), exponent, &exp10);
+  }
+  d = jsmn_format_digits(buf + sizeof(buf), digits);
+  return jsmn_format_decimal(out, (int)(bits >> 63), d,
+                             (int)(buf + sizeof(buf) - d),
+                             (int)(buf + sizeof(buf) - d) + exp10);
+}
+#else
+/**
+ * Sets a decimal to an integer below 2^53, taken in two halves of 8 digits.
+ */
+static void jsmn_decimal_set(jsmn_decimal *a, const double n) {
+  unsigned long hi = (unsigned long)(n / 1e8), lo;
+  double r = n - (double)hi * 1e8;
+  int i, z;
+
+  if (r < 0) {
+    hi--;
+    r += 1e8;
+  }
+  lo = (unsigned long)r;
+  for (i = 16; i >= 9; i--) {
+    a->d[i] = (unsigned char)(lo % 10);
+    lo /= 10;
+  }
+  for (; i >= 0; i--) {
+    a->d[i] = (unsigned char)(hi % 10);
+    hi /= 10;
+  }
+  for (z = 0; z < 17 && a->d[z] == 0; z++) {
+  }
+  for (i = z; i < 17; i++) {
+    a->d[i - z] = a->d[i];
+  }
+  a->nd = 17 - z;
+  a->dp = 17 - z;
+  a->trunc = 0;
+  jsmn_decimal_trim(a);
+}
+
+/**
+ * Adds 1/2 to an integer decimal.
+ */
+static void jsmn_decimal_half(jsmn_decimal *a) {
+  for (; a->nd < a->dp; a->nd++) {
+    a->d[a->nd] = 0;
+  }
+  a->d[a->nd++] = 5;
+}
+
+/**
+ * Cuts a decimal to its first nd digits, rounding up if up is set.
+ */
+static void jsmn_decimal_round(jsmn_decimal *a, int nd, const int up) {
+  if (up) {
+    for (; nd > 0 && a->d[nd - 1] == 9; nd--) {
+    }
+    if (nd == 0) {
+      a->d[0] = 1;
+      nd = 1;
+      a->dp++;
+    } else {
+      a->d[nd - 1]++;
+    }
+  }
+  a->nd = nd;
+  jsmn_decimal_trim(a);
+}
+
+/**
+ * Formats a finite double, writes at most 25 bytes. Without 64-bit integers
+ * the double is split into a 53-bit mantissa and a power of two with
+ * multiplications, which are exact, and written out as a decimal. It is then
+ * rounded to the fewest digits that stay between the decimals halfway to the
+ * doubles on either side, as strconv of Go does.
+ */
+static size_t jsmn_format_double(char *out, const double value) {
+  jsmn_decimal d, upper, lower;
+  double m = value < 0 ? -value : value;
+  int exp = 52, ui, mi, li, l, u, c, inclusive, okdown, okup, delta = 0;
+  char digits[17];
+
+  if (m == 0) {
+    return jsmn_format_decimal(out, 1 / value < 0, "0", 1, 1);
+  }
+  /* m * 2^(exp - 52), m in [2^52, 2^53) or a subnormal with exp = -1022 */
+  if (m < DBL_MIN) {
+    m = m * jsmn_pow2(537) * jsmn_pow2(537);
+    exp = -1022;
+  } else {
+    for (; m >= 38685626227668133590597632.0; exp += 32) {
+      m *= 2.3283064365386962890625e-10;
+    }
+    for (; m < 1048576.0; exp -= 32) {
+      m *= 4294967296.0;
+    }
+    for (; m >= 9007199254740992.0; exp++) {
+      m *= 0.5;
+    }
+    for (; m < 4503599627370496.0; exp--) {
+      m *= 2;
+    }
+  }
+  jsmn_decimal_set(&d, m);
+  /* Even mantissas also own the halfway points to the doubles around */
+  inclusive = d.nd < d.dp || d.d[d.nd - 1] % 2 == 0;
+  jsmn_decimal_shift(&d, exp - 52);
+
+  /* Integers with enough zeros at the end are already the shortest */
+  if (exp == -1022 || 332 * (d.dp - d.nd) < 100 * (exp - 52)) {
+    jsmn_decimal_set(&upper, m);
+    jsmn_decimal_half(&upper);
+    jsmn_decimal_shift(&upper, exp - 52);
+    if (m > 4503599627370496.0 || exp == -1022) {
+      jsmn_decimal_set(&lower, m - 1);
+      jsmn_decimal_half(&lower);
+      jsmn_decimal_shift(&lower, exp - 52);
+    } else {
+      /* The double below a power of two is half as far */
+      jsmn_decimal_set(&lower, 2 * m - 1);
+      jsmn_decimal_half(&lower);
+      jsmn_decimal_shift(&lower, exp - 53);
+    }
+    for (ui = 0;; ui++) {
+      mi = ui - upper.dp + d.dp;
+      li = ui - upper.dp + lower.dp;
+      if (mi >= d.nd) {
+        break;
+      }
+      l = li >= 0 && li < lower.nd ? lower.d[li] : 0;
+      c = mi >= 0 ? d.d[mi] : 0;
+      u = ui < upper.nd ? upper.d[ui] : 0;
+      okdown = l != c || (inclusive && li + 1 == lower.nd);
+      if (delta == 0 && c + 1 < u) {
+        delta = 2;
+      } else if (delta == 0 && c != u) {
+        delta = 1;
+      } else if (delta == 1 && (c != 9 || u != 0)) {
+        delta = 2;
+      }
+      okup = delta > 0 && (inclusive || delta > 1 || ui + 1 < upper.nd);
+      if (okdown || okup) {
+        jsmn_decimal_round(&d, mi + 1,
+                           okdown && okup ? jsmn_decimal_round_up(&d, mi + 1)
+                                          : okup);
+        break;
+      }
+    }
+  }
+  for (ui = 0; ui < d.nd; ui++) {
+    digits[ui] = (char)('0' + d.d[ui]);
+  }
+  return jsmn_format_decimal(out, value < 0, digits, d.nd, d.dp);
+}
+#endif /* JSMN_HAS_INT64 */
+
+/**
+ * Start writing into a buffer.
+ */
+JSMN_API void jsmn_writer_init(jsmn_writer *writer, char *buf,
+                               const size_t size,
+                               void *(*grow)(void *user, void *ptr,
+                                             size_t size),
+                               void *user) {
+  writer->buf = buf;
+  writer->len = 0;
+  writer->size = buf == NULL ? 0 : size;
+  writer->grow = grow;
+  writer->user = user;
+  writer->error = 0;
+  writer->comma = 0;
+  writer->depth = 0;
+}
+
+/**
+ * Opens an object or an array.
+ */
+static int jsmn_writer_begin(jsmn_writer *writer, const char c) {
+  if (jsmn_writer_start(writer, 1) < 0) {
+    return writer->error;
+  }
+  writer->buf[writer->len++] = c;
+  writer->comma = 0;
+  writer->depth++;
+  return 0;
+}
+
+/**
+ * Closes an object or an array.
+ */
+static int jsmn_writer_end(jsmn_writer *writer, const char c) {
+  if (writer->error != 0) {
+    return writer->error;
+  }
+  if (writer->depth == 0) {
+    return writer->error = JSMN_ERROR_INVAL;
+  }
+  if (jsmn_writer_reserve(writer, 1) < 0) {
+    return writer->error;
+  }
+  writer->buf[writer->len++] = c;
+  writer->comma = 1;
+  writer->depth--;
+  return 0;
+}
+
+JSMN_API int jsmn_write_begin_object(jsmn_writer *writer) {
+  return jsmn_writer_begin(writer, '{');
+}
+
+JSMN_API int jsmn_write_end_object(jsmn_writer *writer) {
+  return jsmn_writer_end(writer, '}');
+}
+
+JSMN_API int jsmn_write_begin_array(jsmn_writer *writer) {
+  return jsmn_writer_begin(writer, '[');
+}
+
+JSMN_API int jsmn_write_end_array(jsmn_writer *writer) {
+  return jsmn_writer_end(writer, ']');
+}
+
+/**
+ * Write a key and the colon after it.
+ */
+JSMN_API int jsmn_write_key(jsmn_writer *writer, const char *key,
+                            const size_t len) {
+  return jsmn_writer_quoted(writer, key, len, 1);
+}
+
+/**
+ * Write a string value.
+ */
+JSMN_API int jsmn_write_string(jsmn_writer *writer, const char *str,
+                               const size_t len) {
+  return jsmn_writer_quoted(writer, str, len, 0);
+}
+
+/**
+ * Write a double with the fewest digits that read back as the same value.
+ */
+JSMN_API int jsmn_write_double(jsmn_writer *writer, const double value) {
+  if (writer->error == 0 && !(value >= -DBL_MAX && value <= DBL_MAX)) {
+    writer->error = JSMN_ERROR_INVAL;
+  }
+  if (jsmn_writer_start(writer, 25) < 0) {
+    return writer->error;
+  }
+  writer->len += jsmn_format_double(writer->buf + writer->len, value);
+  writer->comma = 1;
+  return 0;
+}
+
+#ifdef JSMN_HAS_INT64
+/**
+ * Write a signed integer.
+ */
+JSMN_API int jsmn_write_int64(jsmn_writer *writer, const int64_t value) {
+  if (jsmn_writer_start(writer, 24) < 0) {
+    return writer->error;
+  }
+  writer->len += jsmn_format_integer(
+      writer->buf + writer->len, value < 0,
+      value < 0 ? 0 - (uint64_t)value : (uint64_t)value);
+  writer->comma = 1;
+  return 0;
+}
+
+/**
+ * Write an unsigned integer.
+ */
+JSMN_API int jsmn_write_uint64(jsmn_writer *writer, const uint64_t value) {
+  if (jsmn_writer_start(writer, 24) < 0) {
+    return writer->error;
+  }
+  writer->len += jsmn_format_integer(writer->buf + writer->len, 0, value);
+  writer->comma = 1;
+  return 0;
+}
+#endif
+
+JSMN_API int jsmn_write_bool(jsmn_writer *writer, const int value) {
+  return value ? jsmn_writer_value(writer, "true", 4)
+               : jsmn_writer_value(writer, "false", 5);
+}
+
+JSMN_API int jsmn_write_null(jsmn_writer *writer) {
+  return jsmn_writer_value(writer, "null", 4);
+}
+
+/**
+ * Write JSON text as it is.
+ */
+JSMN_API int jsmn_write_raw(jsmn_writer *writer, const char *js,
+                            const size_t len) {
+  return jsmn_writer_value(writer, js, len);
+}
+
+/**
+ * Appends n bytes as they are, without a comma.
+ */
+static int jsmn_writer_append(jsmn_writer *writer, const char *s,
+                              const size_t n) {
+  char *out;
+  size_t i;
+
+  if (writer->error != 0 || jsmn_writer_reserve(writer, n) < 0) {
+    return writer->error;
+  }
+  out = writer->buf + writer->len;
+  for (i = 0; i < n; i++) {
+    out[i] = s[i];
+  }
+  writer->len += n;
+  return 0;
+}
+
+/**
+ * Byte range of a value, strings with their quotes.
+ */
+static jsmnint_t jsmn_value_start(const jsmntok_t *tok) {
+  return tok->type == JSMN_STRING ? tok->start - 1 : tok->start;
+}
+
+static jsmnint_t jsmn_value_end(const jsmntok_t *tok) {
+  return tok->type == JSMN_STRING ? tok->end + 1 : tok->end;
+}
+
+/**
+ * Returns the index of the first token after a value and everything nested
+ * in it.
+ */
+static jsmnint_t jsmn_skip_tokens(const jsmntok_t *tokens, jsmnint_t i) {
+#ifdef JSMN_SKIP_LINKS
+  return tokens[i].next;
+#else
+  jsmnint_t left = 1;
+  for (; left > 0; i++) {
+    left += (jsmnint_t)tokens[i].size - 1;
+  }
+  return i;
+#endif
+}
+
+/**
+ * Returns the object or array holding a token, or -1.
+ */
+static jsmnint_t jsmn_patch_parent(const jsmntok_t *tokens, const jsmnint_t i) {
+#ifdef JSMN_PARENT_LINKS
+  /* Object values point to their keys, which are no containers */
+  return tokens[i].parent;
+#else
+  jsmnint_t p;
+  for (p = i - 1; p >= 0; p--) {
+    if ((tokens[p].type == JSMN_OBJECT || tokens[p].type == JSMN_ARRAY) &&
+        tokens[p].end > tokens[i].start) {
+      return p;
+    }
+  }
+  return -1;
+#endif
+}
+
+/**
+ * Tells whether a member or element is kept, i.e. not deleted by any edit.
+ */
+static int jsmn_patch_kept(const jsmn_patch *patches, const unsigned int n,
+                           const jsmnint_t i) {
+  unsigned int k;
+  for (k = 0; k < n; k++) {
+    if (patches[k].op == JSMN_PATCH_DELETE && patches[k].token == i) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Tells whether an object or array keeps any of its members or elements.
+ */
+static int jsmn_patch_nonempty(const jsmntok_t *tokens,
+                               const jsmn_patch *patches, const unsigned int n,
+                               const jsmnint_t parent) {
+  const int object = tokens[parent].type == JSMN_OBJECT;
+  jsmnint_t i = parent + 1, k;
+
+  for (k = 0; k < (jsmnint_t)tokens[parent].size; k++) {
+    if (jsmn_patch_kept(patches, n, i)) {
+      return 1;
+    }
+    i = jsmn_skip_tokens(tokens, object ? i + 1 : i);
+  }
+  return 0;
+}
+
+/**
+ * Finds the bytes a deleted member or element takes with one comma next to
+ * it: the one before it if any member before it is kept, otherwise the one
+ * after it. Runs of deleted members then take adjacent ranges.
+ */
+static int jsmn_patch_delete(const jsmntok_t *tokens,
+                             const jsmnint_t num_tokens,
+                             const jsmn_patch *patches, const unsigned int n,
+                             jsmn_patch *patch) {
+  const jsmnint_t parent = jsmn_patch_parent(tokens, patch->token);
+  jsmnint_t i, k, value, prev_end = 0;
+  int object, kept = 0;
+
+  if (parent < 0 || (tokens[parent].type != JSMN_OBJECT &&
+                     tokens[parent].type != JSMN_ARRAY)) {
+    return JSMN_ERROR_INVAL;
+  }
+  object = tokens[parent].type == JSMN_OBJECT;
+  i = parent + 1;
+  for (k = 0; k < (jsmnint_t)tokens[parent].size && i != patch->token; k++) {
+    kept |= jsmn_patch_kept(patches, n, i);
+    value = object ? i + 1 : i;
+    prev_end = jsmn_value_end(&tokens[value]);
+    i = jsmn_skip_tokens(tokens, value);
+  }
+  /* Object values are not members, their keys are */
+  if (k == (jsmnint_t)tokens[parent].size) {
+    return JSMN_ERROR_INVAL;
+  }
+  value = object ? i + 1 : i;
+  if (kept) {
+    patch->from = prev_end;
+    patch->to = jsmn_value_end(&tokens[value]);
+  } else {
+    patch->from = jsmn_value_start(&tokens[i]);
+    i = jsmn_skip_tokens(tokens, value);
+    patch->to = k + 1 < (jsmnint_t)tokens[parent].size && i < num_tokens
+                    ? jsmn_value_start(&tokens[i])
+                    : jsmn_value_end(&tokens[value]);
+  }
+  return 0;
+}
+
+/**
+ * Finds where an edit goes in the JSON string.
+ */
+static int jsmn_patch_range(const char *js, const jsmntok_t *tokens,
+                            const jsmnint_t num_tokens,
+                            const jsmn_patch *patches, const unsigned int n,
+                            jsmn_patch *patch) {
+  const jsmntok_t *tok;
+  jsmnint_t pos;
+
+  if (patch->token < 0 || patch->token >= num_tokens) {
+    return JSMN_ERROR_INVAL;
+  }
+  tok = &tokens[patch->token];
+  switch (patch->op) {
+  case JSMN_PATCH_REPLACE:
+    patch->from = jsmn_value_start(tok);
+    patch->to = jsmn_value_end(tok);
+    return 0;
+  case JSMN_PATCH_DELETE:
+    return jsmn_patch_delete(tokens, num_tokens, patches, n, patch);
+  case JSMN_PATCH_INSERT:
+    if (tok->type != JSMN_ARRAY &&
+        (tok->type != JSMN_OBJECT || patch->key == NULL)) {
+      return JSMN_ERROR_INVAL;
+    }
+    /* Right after the last member, or the opening bracket */
+    pos = tok->end - 1;
+    if (tok->size > 0) {
+      while (js[pos - 1] == ' ' || js[pos - 1] == '\t' || js[pos - 1] == '\n' ||
+             js[pos - 1] == '\r') {
+        pos--;
+      }
+    } else {
+      pos = tok->start + 1;
+    }
+    patch->from = patch->to = pos;
+    return 0;
+  default:
+    return JSMN_ERROR_INVAL;
+  }
+}
+
+/**
+ * Tells whether edit a comes before edit b, inserts before what follows them
+ * and edits at the same place in the order given.
+ */
+static int jsmn_patch_before(const jsmn_patch *patches, const unsigned int a,
+                             const unsigned int b) {
+  if (patches[a].from != patches[b].from) {
+    return patches[a].from < patches[b].from;
+  }
+  if (patches[a].to != patches[b].to) {
+    return patches[a].to < patches[b].to;
+  }
+  return a < b;
+}
+
+/**
+ * Writes the new text of an edit.
+ */
+static int jsmn_patch_write(jsmn_writer *writer, const jsmntok_t *tokens,
+                            const jsmn_patch *patches, const unsigned int n,
+                            const unsigned int k) {
+  const jsmn_patch *patch = &patches[k];
+  unsigned int i;
+
+  if (patch->op == JSMN_PATCH_DELETE) {
+    return 0;
+  }
+  if (patch->op == JSMN_PATCH_INSERT) {
+    /* A comma goes after kept members and members inserted before */
+    writer->comma = jsmn_patch_nonempty(tokens, patches, n, patch->token);
+    for (i = 0; i < k && !writer->comma; i++) {
+      writer->comma = patches[i].op == JSMN_PATCH_INSERT &&
+                      patches[i].token == patch->token;
+    }
+    if (tokens[patch->token].type == JSMN_OBJECT) {
+      jsmn_writer_quoted(writer, patch->key, patch->key_len, 1);
+    } else if (writer->comma) {
+      jsmn_writer_append(writer, ",", 1);
+    }
+  }
+  return jsmn_writer_append(writer, patch->value, patch->value_len);
+}
+
+/**
+ * Write a parsed document with edits applied.
+ */
+JSMN_API int jsmn_write_patched(jsmn_writer *writer, const char *js,
+                                const jsmntok_t *tokens,
+                                const jsmnint_t num_tokens,
+                                jsmn_patch *patches,
+                                const unsigned int num_patches) {
+  jsmnint_t pos, end;
+  unsigned int i, k, next, prev = num_patches;
+
+  if (writer->error != 0) {
+    return writer->error;
+  }
+  if (num_tokens <= 0) {
+    return writer->error = JSMN_ERROR_INVAL;
+  }
+  pos = jsmn_value_start(&tokens[0]);
+  end = jsmn_value_end(&tokens[0]);
+  /* Check all edits before writing anything */
+  for (i = 0; i < num_patches; i++) {
+    if (jsmn_patch_range(js, tokens, num_tokens, patches, num_patches,
+                         &patches[i]) < 0 ||
+        patches[i].from < pos || patches[i].to > end) {
+      return writer->error = JSMN_ERROR_INVAL;
+    }
+    for (k = 0; k < i; k++) {
+      if (patches[i].from < patches[k].to && patches[k].from < patches[i].to) {
+        return writer->error = JSMN_ERROR_INVAL;
+      }
+    }
+  }
+
+  if (jsmn_writer_start(writer, 0) < 0) {
+    return writer->error;
+  }
+  /* Edits are few, picking the next one each time is cheaper than sorting */
+  for (i = 0; i < num_patches; i++) {
+    next = num_patches;
+    for (k = 0; k < num_patches; k++) {
+      if ((prev == num_patches || jsmn_patch_before(patches, prev, k)) &&
+          (next == num_patches || jsmn_patch_before(patches, k, next))) {
+        next = k;
+      }
+    }
+    jsmn_writer_append(writer, js + pos, (size_t)(patches[next].from - pos));
+    jsmn_patch_write(writer, tokens, patches, num_patches, next);
+    pos = patches[next].to;
+    prev = next;
+  }
+  jsmn_writer_append(writer, js + pos, (size_t)(end - pos));
+  writer->comma = 1;
+  return writer->error;
+}
+
+/**
+ * Creates a new parser based over a given buffer with an array of tokens
+ * available.
+ */
+JSMN_API void jsmn_init(jsmn_parser *parser) {
+  parser->pos = 0;
+  parser->toknext = 0;
+  parser->toksuper = -1;
+  parser->depth = 0;
+  parser->tokstart = -1;
+  parser->escape = 0;
+  parser->element = JSMN_ELEMENT_START;
+#ifdef JSMN_ESCAPE_FLAGS
+  parser->escaped = 0;
+#endif
+#ifdef JSMN_STATS
+  {
+    const size_t n =
+        sizeof parser->stats.tokens / sizeof parser->stats.tokens[0];
+    size_t i;
+    parser->stats.bytes = 0;
+    parser->stats.rescanned = 0;
+    for (i = 0; i < n; i++) {
+      parser->stats.tokens[i] = 0;
+    }
+    parser->stats.max_depth = 0;
+    parser->stats.scan_steps = 0;
+    parser->stats.restarts = 0;
+    parser->stats.scanned_end = 0;
+    parser->stats.partial = 0;
+  }
+#endif
 }
 
 #endif /* JSMN_HEADER */
@@ -0,0 +1,861 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2010 Serge Zaitsev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef JSMN_HPP
+#define JSMN_HPP
+
+/*
+ * Read-only C++17 views over parsed tokens. Nothing is copied or allocated:
+ * a value is the JSON string, the tokens and an index.
+ *
+ *   jsmn::document doc(js, tokens, r);
+ *   for (auto [key, v] : doc.root().as_object()) {
+ *     if (key == "uid") {
+ *       uid = v.as<int>();
+ *     }
+ *   }
+ *   for (jsmn::value g : doc.root()["groups"].as_array()) {
+ *     std::string_view name = g.str();
+ *   }
+ *
+ * The C functions come from jsmn.h, which is included as it is: like with
+ * jsmn.h, define JSMN_HEADER in all but one of the files that include this
+ * header, or JSMN_STATIC in all of them.
+ */
+
+#include "jsmn.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace jsmn {
+
+namespace detail {
+
+/**
+ * Returns the index of the first token after the value at token i: one step
+ * with JSMN_SKIP_LINKS, otherwise a loop over the tokens of the value.
+ */
+inline jsmnint_t skip(const jsmntok_t *tokens, jsmnint_t i) {
+#ifdef JSMN_SKIP_LINKS
+  return tokens[i].next;
+#else
+  jsmnint_t left = 1;
+  for (; left > 0; i++) {
+    left += static_cast<jsmnint_t>(tokens[i].size) - 1;
+  }
+  return i;
+#endif
+}
+
+template <typename T>
+constexpr bool is_scalar_v =
+    std::is_arithmetic_v<T> || std::is_same_v<T, std::string_view> ||
+    std::is_same_v<T, std::string>;
+
+/**
+ * Converts a token to bool, a number, std::string_view (escape sequences are
+ * left as they are) or std::string (unescaped). Returns 0, JSMN_ERROR_INVAL
+ * for a token of another type, or JSMN_ERROR_RANGE if a number doesn't fit.
+ */
+template <typename T>
+int convert(const char *js, const jsmntok_t *tok, T &out) {
+  static_assert(is_scalar_v<T>, "no conversion from a token to this type");
+  if constexpr (std::is_same_v<T, bool>) {
+    std::string_view s(js + tok->start,
+                       static_cast<std::size_t>(tok->end - tok->start));
+    if (tok->type != JSMN_PRIMITIVE || (s != "true" && s != "false")) {
+      return JSMN_ERROR_INVAL;
+    }
+    out = s == "true";
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    std::int64_t v;
+    int r = jsmn_tok_to_int64(js, tok, &v);
+    if (r < 0) {
+      return r;
+    }
+    if (v < std::numeric_limits<T>::min() ||
+        v > std::numeric_limits<T>::max()) {
+      return JSMN_ERROR_RANGE;
+    }
+    out = static_cast<T>(v);
+  } else if constexpr (std::is_integral_v<T>) {
+    std::uint64_t v;
+    int r = jsmn_tok_to_uint64(js, tok, &v);
+    if (r < 0) {
+      return r;
+    }
+    if (v > std::numeric_limits<T>::max()) {
+      return JSMN_ERROR_RANGE;
+    }
+    out = static_cast<T>(v);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    double v;
+    int r = jsmn_tok_to_double(js, tok, &v);
+    if (r < 0) {
+      return r;
+    }
+    out = static_cast<T>(v);
+  } else if constexpr (std::is_same_v<T, std::string_view>) {
+    if (tok->type != JSMN_STRING) {
+      return JSMN_ERROR_INVAL;
+    }
+    out = std::string_view(js + tok->start,
+                           static_cast<std::size_t>(tok->end - tok->start));
+  } else {
+    jsmnint_t n;
+    if (tok->type != JSMN_STRING) {
+      return JSMN_ERROR_INVAL;
+    }
+    T s(static_cast<std::size_t>(tok->end - tok->start), '\0');
+    n = jsmn_unescape(js, tok, &s[0], s.size());
+    if (n < 0) {
+      return static_cast<int>(n);
+    }
+    s.resize(static_cast<std::size_t>(n));
+    out = std::move(s);
+  }
+  return 0;
+}
+
+} /* namespace detail */
+
+class object;
+class array;
+
+/**
+ * Any JSON value, or a missing one (a key not found, an index out of range)
+ * that converts to false and has the type JSMN_UNDEFINED.
+ */
+class value {
+public:
+  value() = default;
+  value(const char *js, const jsmntok_t *tokens, jsmnint_t index)
+      : js_(js), tokens_(tokens), index_(index) {}
+
+  explicit operator bool() const { return tokens_ != nullptr; }
+  const char *json() const { return js_; }
+  const jsmntok_t *tokens() const { return tokens_; }
+  jsmnint_t index() const { return index_; }
+  const jsmntok_t &token() const { return tokens_[index_]; }
+
+  jsmntype_t type() const {
+    return tokens_ != nullptr ? static_cast<jsmntype_t>(token().type)
+                              : JSMN_UNDEFINED;
+  }
+  bool is_object() const { return type() == JSMN_OBJECT; }
+  bool is_array() const { return type() == JSMN_ARRAY; }
+  bool is_string() const { return type() == JSMN_STRING; }
+  bool is_null() const {
+    return type() == JSMN_PRIMITIVE && js_[token().start] == 'n';
+  }
+
+  /* Number of members of an object or elements of an array */
+  jsmnint_t size() const {
+    return is_object() || is_array() ? static_cast<jsmnint_t>(token().size)
+                                     : 0;
+  }
+
+  /* The JSON text of the value, without the quotes of a string */
+  std::string_view raw() const {
+    if (tokens_ == nullptr) {
+      return std::string_view();
+    }
+    return std::string_view(
+        js_ + token().start,
+        static_cast<std::size_t>(token().end - token().start));
+  }
+
+  /* Contents of a string with escape sequences left as they are, or empty */
+  std::string_view str() const {
+    return is_string() ? raw() : std::string_view();
+  }
+
+  /* Unescapes a string into buf, which needs at most raw().size() bytes */
+  std::string_view unescape(char *buf, std::size_t len) const {
+    jsmnint_t n;
+    if (!is_string()) {
+      return std::string_view();
+    }
+    n = jsmn_unescape(js_, &token(), buf, len);
+    return n < 0 ? std::string_view()
+                 : std::string_view(buf, static_cast<std::size_t>(n));
+  }
+
+  /**
+   * Converts the value to bool, a number or a string. Returns 0 or the error
+   * of the conversion, leaving out unchanged.
+   */
+  template <typename T> int get(T &out) const {
+    if (tokens_ == nullptr) {
+      return JSMN_ERROR_INVAL;
+    }
+    return detail::convert(js_, &token(), out);
+  }
+
+  /* The converted value, or fallback if it can't be converted */
+  template <typename T> T as(T fallback = T()) const {
+    get(fallback);
+    return fallback;
+  }
+
+  /* Member of an object by key, compared with the key as it is in JSON */
+  value operator[](std::string_view key) const;
+  value operator[](const char *key) const {
+    return (*this)[std::string_view(key)];
+  }
+  /* Element of an array, counting from 0; walks the elements before it, so
+   * loop over as_array() to visit them all */
+  template <typename I, typename = std::enable_if_t<std::is_integral_v<I>>>
+  value operator[](I i) const;
+
+  /* Views of an object or an array, empty for other values */
+  inline object as_object() const;
+  inline array as_array() const;
+
+private:
+  const char *js_ = nullptr;
+  const jsmntok_t *tokens_ = nullptr;
+  jsmnint_t index_ = 0;
+};
+
+/**
+ * A key and its value, for (auto [key, v] : obj).
+ */
+struct member {
+  std::string_view key;
+  jsmn::value value;
+};
+
+/**
+ * Iterates over the values of an array or the keys of an object, moving past
+ * every value as a whole.
+ */
+template <typename T> class iterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = T;
+
+  iterator() = default;
+  iterator(const char *js, const jsmntok_t *tokens, jsmnint_t pos,
+           jsmnint_t left)
+      : js_(js), tokens_(tokens), pos_(pos), left_(left) {}
+
+  T operator*() const {
+    if constexpr (std::is_same_v<T, member>) {
+      const jsmntok_t &k = tokens_[pos_];
+      return member{std::string_view(js_ + k.start, static_cast<std::size_t>(
+                                                        k.end - k.start)),
+                    value(js_, tokens_, pos_ + 1)};
+    } else {
+      return value(js_, tokens_, pos_);
+    }
+  }
+
+  iterator &operator++() {
+    /* Past the value, and for an object the key before it */
+    pos_ = detail::skip(tokens_, std::is_same_v<T, member> ? pos_ + 1 : pos_);
+    left_--;
+    return *this;
+  }
+  iterator operator++(int) {
+    iterator it = *this;
+    ++*this;
+    return it;
+  }
+
+  /* Iterators of the same object or array are equal with as many values
+   * left, so end() needs no skipping */
+  bool operator==(const iterator &it) const { return left_ == it.left_; }
+  bool operator!=(const iterator &it) const { return left_ != it.left_; }
+
+private:
+  const char *js_ = nullptr;
+  const jsmntok_t *tokens_ = nullptr;
+  jsmnint_t pos_ = 0;
+  jsmnint_t left_ = 0;
+};
+
+/**
+ * An object: range-for over its members, lookup by key.
+ */
+class object {
+public:
+  object() = default;
+  explicit object(const value &v) : v_(v.is_object() ? v : value()) {}
+
+  jsmnint_t size() const { return v_.size(); }
+  iterator<member> begin() const {
+    return iterator<member>(v_.json(), v_.tokens(), v_.index() + 1, size());
+  }
+  iterator<member> end() const { return iterator<member>(); }
+
+  /* Value of the first member with the key as it is in JSON, or a missing
+   * value */
+  value operator[](std::string_view key) const {
+    for (member m : *this) {
+      if (m.key == key) {
+        return m.value;
+      }
+    }
+    return value();
+  }
+
+private:
+  value v_;
+};
+
+/**
+ * An array: range-for over its elements, lookup by position.
+ */
+class array {
+public:
+  array() = default;
+  explicit array(const value &v) : v_(v.is_array() ? v : value()) {}
+
+  jsmnint_t size() const { return v_.size(); }
+  iterator<value> begin() const {
+    return iterator<value>(v_.json(), v_.tokens(), v_.index() + 1, size());
+  }
+  iterator<value> end() const { return iterator<value>(); }
+
+  /* Element i counting from 0, or a missing value. This walks the i elements
+   * before it, so use the iterator to visit them all */
+  value operator[](jsmnint_t i) const {
+    if (i >= 0 && i < size()) {
+      for (value e : *this) {
+        if (i-- == 0) {
+          return e;
+        }
+      }
+    }
+    return value();
+  }
+
+private:
+  value v_;
+};
+
+inline object value::as_object() const { return object(*this); }
+inline array value::as_array() const { return array(*this); }
+inline value value::operator[](std::string_view key) const {
+  return as_object()[key];
+}
+template <typename I, typename>
+inline value value::operator[](I i) const {
+  return as_array()[static_cast<jsmnint_t>(i)];
+}
+
+/**
+ * The tokens of a parsed JSON string; the root value is the first token.
+ */
+class document {
+public:
+  document(const char *js, const jsmntok_t *tokens, jsmnint_t count)
+      : js_(js), tokens_(tokens), count_(count) {}
+
+  value root() const { return count_ > 0 ? value(js_, tokens_, 0) : value(); }
+  /* Any token by index, e.g. one found by a search of the tokens */
+  value at(jsmnint_t i) const {
+    return i >= 0 && i < count_ ? value(js_, tokens_, i) : value();
+  }
+  jsmnint_t count() const { return count_; }
+
+private:
+  const char *js_;
+  const jsmntok_t *tokens_;
+  jsmnint_t count_;
+};
+
+#if __cplusplus >= 202002L
+namespace detail {
+
+/*
+ * The parser of jsmn.h as constexpr functions, so JSON known at compile time
+ * can be parsed at compile time. It follows the same JSMN_* options and gives
+ * the same tokens and errors as jsmn_parse() does for the whole input at once.
+ * Left out: the SIMD string scan, which gives the same offsets, and resuming
+ * after JSMN_ERROR_PART or JSMN_ERROR_NOMEM.
+ */
+
+constexpr jsmntok_t *cx_alloc_token(jsmn_parser &parser, jsmntok_t *tokens,
+                                    const std::size_t num_tokens) {
+  jsmntok_t *tok;
+  if (parser.toknext >= num_tokens) {
+    return nullptr;
+  }
+  tok = &tokens[parser.toknext++];
+  tok->start = tok->end = -1;
+  tok->size = 0;
+#ifdef JSMN_PARENT_LINKS
+  tok->parent = -1;
+#endif
+#ifdef JSMN_SKIP_LINKS
+  tok->next = -1;
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+  tok->escaped = 0;
+#endif
+  return tok;
+}
+
+constexpr int cx_add_child(jsmntok_t *token) {
+#ifdef JSMN_COMPACT
+  if (token->size == JSMN_MAX_SIZE) {
+    return JSMN_ERROR_RANGE;
+  }
+#endif
+  token->size++;
+  return 0;
+}
+
+constexpr void cx_fill_token(jsmntok_t *token, const jsmntype_t type,
+                             const jsmnint_t start, const jsmnint_t end) {
+  token->type = type;
+  token->start = start;
+  token->end = end;
+  token->size = 0;
+}
+
+/* Characters that end a primitive */
+constexpr bool cx_primitive_end(const char c) {
+  switch (c) {
+#ifndef JSMN_STRICT
+  case ':':
+#endif
+  case '\t':
+  case '\r':
+  case '\n':
+  case ' ':
+  case ',':
+  case ']':
+  case '}':
+    return true;
+  default:
+    return false;
+  }
+}
+
+constexpr int cx_parse_primitive(jsmn_parser &parser, const char *js,
+                                 const std::size_t len, jsmntok_t *tokens,
+                                 const std::size_t num_tokens) {
+  jsmntok_t *token;
+  jsmnuint_t pos = parser.pos;
+  const jsmnint_t start = static_cast<jsmnint_t>(pos);
+
+  for (; pos < len && js[pos] != '\0' && !cx_primitive_end(js[pos]); pos++) {
+    if (js[pos] < 32 || js[pos] >= 127) {
+      return JSMN_ERROR_INVAL;
+    }
+  }
+#ifdef JSMN_STRICT
+  /* In strict mode primitive must be followed by a comma/object/array */
+  if (pos >= len || js[pos] == '\0') {
+    return JSMN_ERROR_PART;
+  }
+#endif
+
+  parser.pos = pos;
+  if (tokens == nullptr) {
+    parser.pos--;
+    return 0;
+  }
+  token = cx_alloc_token(parser, tokens, num_tokens);
+  if (token == nullptr) {
+    return JSMN_ERROR_NOMEM;
+  }
+  cx_fill_token(token, JSMN_PRIMITIVE, start, static_cast<jsmnint_t>(pos));
+#ifdef JSMN_PARENT_LINKS
+  token->parent = parser.toksuper;
+#endif
+#ifdef JSMN_SKIP_LINKS
+  token->next = static_cast<jsmnint_t>(parser.toknext);
+#endif
+  parser.pos--;
+  return 0;
+}
+
+constexpr int cx_parse_escape(jsmn_parser &parser, const char *js,
+                              const std::size_t len) {
+  for (; parser.pos < len && js[parser.pos] != '\0'; parser.pos++) {
+    char c = js[parser.pos];
+    if (parser.escape == 1) {
+      switch (c) {
+      case '\"':
+      case '/':
+      case '\\':
+      case 'b':
+      case 'f':
+      case 'r':
+      case 'n':
+      case 't':
+        parser.escape = 0;
+        return 0;
+      case 'u':
+        parser.escape = 2;
+        break;
+      default:
+        return JSMN_ERROR_INVAL;
+      }
+    } else {
+      if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+            (c >= 'a' && c <= 'f'))) {
+        return JSMN_ERROR_INVAL;
+      }
+      if (parser.escape++ == 5) {
+        parser.escape = 0;
+        return 0;
+      }
+    }
+  }
+  if (parser.escape == 1 && parser.pos < len) {
+    return JSMN_ERROR_INVAL;
+  }
+  return JSMN_ERROR_PART;
+}
+
+constexpr int cx_parse_string(jsmn_parser &parser, const char *js,
+                              const std::size_t len, jsmntok_t *tokens,
+                              const std::size_t num_tokens) {
+  jsmntok_t *token;
+  jsmnuint_t pos;
+  const jsmnint_t start = static_cast<jsmnint_t>(parser.pos++);
+#ifdef JSMN_ESCAPE_FLAGS
+  parser.escaped = 0;
+#endif
+
+  for (pos = parser.pos; pos < len && js[pos] != '\0'; pos++) {
+    const char c = js[pos];
+
+    if (c == '\"') {
+      parser.pos = pos;
+      if (tokens == nullptr) {
+        return 0;
+      }
+      token = cx_alloc_token(parser, tokens, num_tokens);
+      if (token == nullptr) {
+        return JSMN_ERROR_NOMEM;
+      }
+      cx_fill_token(token, JSMN_STRING, start + 1, static_cast<jsmnint_t>(pos));
+#ifdef JSMN_PARENT_LINKS
+      token->parent = parser.toksuper;
+#endif
+#ifdef JSMN_SKIP_LINKS
+      token->next = static_cast<jsmnint_t>(parser.toknext);
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+      token->escaped = parser.escaped;
+#endif
+      return 0;
+    }
+
+    if (c == '\\') {
+      int r;
+#ifdef JSMN_ESCAPE_FLAGS
+      parser.escaped = 1;
+#endif
+      parser.pos = pos + 1;
+      parser.escape = 1;
+      r = cx_parse_escape(parser, js, len);
+      pos = parser.pos;
+      if (r == JSMN_ERROR_PART) {
+        return r;
+      }
+      if (r < 0) {
+        return JSMN_ERROR_INVAL;
+      }
+    }
+  }
+  return JSMN_ERROR_PART;
+}
+
+constexpr int cx_parse_symbol(jsmn_parser &parser, const char *js,
+                              const std::size_t len, jsmntok_t *tokens,
+                              const std::size_t num_tokens) {
+  int r;
+#if !defined(JSMN_MAX_DEPTH) && !defined(JSMN_PARENT_LINKS)
+  jsmnint_t i;
+#endif
+  jsmntok_t *token;
+  jsmntype_t type;
+  const char c = js[parser.pos];
+
+  switch (c) {
+  case '{':
+  case '[':
+    if (tokens == nullptr) {
+      return 1;
+    }
+#ifdef JSMN_MAX_DEPTH
+    if (parser.depth >= JSMN_MAX_DEPTH) {
+      return JSMN_ERROR_DEPTH;
+    }
+#endif
+    token = cx_alloc_token(parser, tokens, num_tokens);
+    if (token == nullptr) {
+      return JSMN_ERROR_NOMEM;
+    }
+    if (parser.toksuper != -1) {
+      jsmntok_t *t = &tokens[parser.toksuper];
+#ifdef JSMN_STRICT
+      if (t->type == JSMN_OBJECT) {
+        return JSMN_ERROR_INVAL;
+      }
+#endif
+      if (cx_add_child(t) < 0) {
+        return JSMN_ERROR_RANGE;
+      }
+#ifdef JSMN_PARENT_LINKS
+      token->parent = parser.toksuper;
+#endif
+    }
+    token->type = (c == '{' ? JSMN_OBJECT : JSMN_ARRAY);
+    token->start = static_cast<jsmnint_t>(parser.pos);
+    parser.toksuper = static_cast<jsmnint_t>(parser.toknext) - 1;
+#ifdef JSMN_MAX_DEPTH
+    parser.stack[parser.depth] = parser.toksuper;
+#endif
+    parser.depth++;
+    return 1;
+  case '}':
+  case ']':
+    if (tokens == nullptr) {
+      break;
+    }
+    type = (c == '}' ? JSMN_OBJECT : JSMN_ARRAY);
+#if defined(JSMN_MAX_DEPTH)
+    if (parser.depth == 0) {
+      return JSMN_ERROR_INVAL;
+    }
+    token = &tokens[parser.stack[parser.depth - 1]];
+    if (token->type != type) {
+      return JSMN_ERROR_INVAL;
+    }
+    token->end = static_cast<jsmnint_t>(parser.pos) + 1;
+#ifdef JSMN_SKIP_LINKS
+    token->next = static_cast<jsmnint_t>(parser.toknext);
+#endif
+    parser.depth--;
+    parser.toksuper = parser.depth > 0 ? parser.stack[parser.depth - 1] : -1;
+#elif defined(JSMN_PARENT_LINKS)
+    if (parser.toknext < 1) {
+      return JSMN_ERROR_INVAL;
+    }
+    token = &tokens[parser.toknext - 1];
+    for (;;) {
+      if (token->start != -1 && token->end == -1) {
+        if (token->type != type) {
+          return JSMN_ERROR_INVAL;
+        }
+        token->end = static_cast<jsmnint_t>(parser.pos) + 1;
+#ifdef JSMN_SKIP_LINKS
+        token->next = static_cast<jsmnint_t>(parser.toknext);
+#endif
+        parser.depth--;
+        parser.toksuper = token->parent;
+        break;
+      }
+      if (token->parent == -1) {
+        if (token->type != type || parser.toksuper == -1) {
+          return JSMN_ERROR_INVAL;
+        }
+        break;
+      }
+      token = &tokens[token->parent];
+    }
+#else
+    for (i = static_cast<jsmnint_t>(parser.toknext) - 1; i >= 0; i--) {
+      token = &tokens[i];
+      if (token->start != -1 && token->end == -1) {
+        if (token->type != type) {
+          return JSMN_ERROR_INVAL;
+        }
+        parser.toksuper = -1;
+        token->end = static_cast<jsmnint_t>(parser.pos) + 1;
+#ifdef JSMN_SKIP_LINKS
+        token->next = static_cast<jsmnint_t>(parser.toknext);
+#endif
+        parser.depth--;
+        break;
+      }
+    }
+    if (i == -1) {
+      return JSMN_ERROR_INVAL;
+    }
+    for (; i >= 0; i--) {
+      token = &tokens[i];
+      if (token->start != -1 && token->end == -1) {
+        parser.toksuper = i;
+        break;
+      }
+    }
+#endif
+    break;
+  case '\"':
+    r = cx_parse_string(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    if (parser.toksuper != -1 && tokens != nullptr &&
+        cx_add_child(&tokens[parser.toksuper]) < 0) {
+      return JSMN_ERROR_RANGE;
+    }
+    return 1;
+  case '\t':
+  case '\r':
+  case '\n':
+  case ' ':
+    break;
+  case ':':
+    parser.toksuper = static_cast<jsmnint_t>(parser.toknext) - 1;
+    break;
+  case ',':
+    if (tokens != nullptr && parser.toksuper != -1 &&
+        tokens[parser.toksuper].type != JSMN_ARRAY &&
+        tokens[parser.toksuper].type != JSMN_OBJECT) {
+#if defined(JSMN_MAX_DEPTH)
+      parser.toksuper = parser.depth > 0 ? parser.stack[parser.depth - 1] : -1;
+#elif defined(JSMN_PARENT_LINKS)
+      parser.toksuper = tokens[parser.toksuper].parent;
+#else
+      for (i = static_cast<jsmnint_t>(parser.toknext) - 1; i >= 0; i--) {
+        if (tokens[i].type == JSMN_ARRAY || tokens[i].type == JSMN_OBJECT) {
+          if (tokens[i].start != -1 && tokens[i].end == -1) {
+            parser.toksuper = i;
+            break;
+          }
+        }
+      }
+#endif
+    }
+    break;
+#ifdef JSMN_STRICT
+  case '-':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+  case 't':
+  case 'f':
+  case 'n':
+    if (tokens != nullptr && parser.toksuper != -1) {
+      const jsmntok_t *t = &tokens[parser.toksuper];
+      if (t->type == JSMN_OBJECT ||
+          (t->type == JSMN_STRING && t->size != 0)) {
+        return JSMN_ERROR_INVAL;
+      }
+    }
+#else
+  default:
+#endif
+    r = cx_parse_primitive(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    if (parser.toksuper != -1 && tokens != nullptr &&
+        cx_add_child(&tokens[parser.toksuper]) < 0) {
+      return JSMN_ERROR_RANGE;
+    }
+    return 1;
+#ifdef JSMN_STRICT
+  default:
+    return JSMN_ERROR_INVAL;
+#endif
+  }
+  return 0;
+}
+
+constexpr jsmnint_t cx_parse(const char *js, const std::size_t len,
+                             jsmntok_t *tokens, const jsmnuint_t num_tokens) {
+  jsmn_parser parser{};
+  jsmnint_t count = 0;
+
+  parser.toksuper = -1;
+  parser.tokstart = -1;
+  for (; parser.pos < len && js[parser.pos] != '\0'; parser.pos++) {
+    int r = cx_parse_symbol(parser, js, len, tokens, num_tokens);
+    if (r < 0) {
+      return r;
+    }
+    count += r;
+  }
+  if (tokens != nullptr && parser.depth > 0) {
+    return JSMN_ERROR_PART;
+  }
+  return count;
+}
+
+} /* namespace detail */
+
+/**
+ * Tokens of JSON parsed at compile time.
+ */
+template <std::size_t N> struct static_tokens {
+  std::array<jsmntok_t, N> tokens;
+  jsmnint_t count; /* number of tokens or an error */
+
+  document doc(const char *js) const {
+    return document(js, tokens.data(), count);
+  }
+};
+
+/**
+ * Parses JSON into at most N tokens, at compile time when used as a constant
+ * expression. The tokens and the count or error are the same as from
+ * jsmn_parse() with the same options; unused tokens are zero.
+ */
+template <std::size_t N>
+constexpr static_tokens<N> parse_static(std::string_view js) {
+  static_assert(N > 0, "jsmn::parse_static needs room for a token");
+  static_tokens<N> r{};
+  r.count = detail::cx_parse(js.data(), js.size(), r.tokens.data(), N);
+  return r;
+}
+
+/**
+ * Number of tokens parse_static() needs, like jsmn_parse() without tokens.
+ */
+constexpr jsmnint_t count_tokens(std::string_view js) {
+  return detail::cx_parse(js.data(), js.size(), nullptr, 0);
+}
+#endif /* C++20 */
+
+} /* namespace jsmn */
+
+#endif /* JSMN_HPP */
@@ -0,0 +1,373 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2010 Serge Zaitsev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef JSMN_BIND_HPP
+#define JSMN_BIND_HPP
+
+/*
+ * Decoding JSON into C++17 structs. A schema lists the keys of a struct:
+ *
+ *   struct user {
+ *     std::string_view name;
+ *     int uid;
+ *     std::vector<std::string_view> groups;
+ *   };
+ *
+ *   template <> struct jsmn::schema<user> {
+ *     static constexpr auto fields =
+ *         jsmn::fields(jsmn::member("user", &user::name),
+ *                      JSMN_MEMBER(user, uid), JSMN_MEMBER(user, groups));
+ *   };
+ *
+ *   user u;
+ *   jsmnint_t r = jsmn::parse(js, len, tokens, 64, u);
+ *
+ * Keys are found with a perfect hash built at compile time from the length and
+ * a few bytes of every key, so a member costs a hash, an indirect call and one
+ * comparison with a key of known length instead of a chain of strncmp().
+ * JSMN_HEADER and JSMN_STATIC work as described in jsmn.hpp.
+ */
+
+#include "jsmn.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jsmn {
+
+/**
+ * Specialize with a static constexpr member "fields" made by jsmn::fields()
+ * to make a struct decodable.
+ */
+template <typename T> struct schema;
+
+/**
+ * A JSON key bound to a data member.
+ */
+template <typename C, typename M> struct field {
+  std::string_view key;
+  M C::*member;
+};
+
+template <typename C, typename M>
+constexpr field<C, M> member(std::string_view key, M C::*ptr) {
+  return field<C, M>{key, ptr};
+}
+
+template <typename... F> constexpr std::tuple<F...> fields(F... f) {
+  return std::tuple<F...>(f...);
+}
+
+/* A member with the same name in C++ and in JSON */
+#define JSMN_MEMBER(type, name) jsmn::member(#name, &type::name)
+
+namespace detail {
+
+/**
+ * Packs the length and the first, middle and last bytes of a key, which tell
+ * most keys apart in a few loads whatever their length.
+ */
+constexpr std::uint32_t key_sample(const char *key, std::size_t len) {
+  if (len == 0) {
+    return 0;
+  }
+  return static_cast<std::uint32_t>(
+      (len & 0xff) | static_cast<unsigned char>(key[0]) << 8 |
+      static_cast<std::uint32_t>(static_cast<unsigned char>(key[len / 2]))
+          << 16 |
+      static_cast<std::uint32_t>(static_cast<unsigned char>(key[len - 1]))
+          << 24);
+}
+
+/**
+ * Hash of a key with a seed, the same at compile time and at run time. With
+ * full set all bytes are hashed (FNV-1a), otherwise only the sample.
+ */
+constexpr std::uint32_t key_hash(const char *key, std::size_t len,
+                                 std::uint32_t seed, bool full) {
+  std::uint32_t h = 2166136261u;
+  if (full) {
+    for (std::size_t i = 0; i < len; i++) {
+      h = (h ^ static_cast<unsigned char>(key[i])) * 16777619u;
+    }
+  } else {
+    h = key_sample(key, len);
+  }
+  h = (h ^ seed) * 0x2c1b3c6du;
+  return h ^ (h >> 15);
+}
+
+template <std::size_t N>
+constexpr bool unique_keys(const std::array<std::string_view, N> &keys,
+                           bool sample) {
+  for (std::size_t i = 0; i < N; i++) {
+    for (std::size_t j = i + 1; j < N; j++) {
+      if (sample ? key_sample(keys[i].data(), keys[i].size()) ==
+                       key_sample(keys[j].data(), keys[j].size())
+                 : keys[i] == keys[j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+constexpr std::size_t next_pow2(std::size_t n) {
+  std::size_t p = 1;
+  while (p < n) {
+    p *= 2;
+  }
+  return p;
+}
+
+struct table_params {
+  std::size_t size;   /* number of slots, a power of two */
+  std::uint32_t seed; /* puts every key in a slot of its own */
+};
+
+/**
+ * Finds the smallest table and a seed for it that hash the keys without
+ * collisions. From about four slots per key on a seed takes a few tries.
+ */
+template <std::size_t N>
+constexpr table_params
+find_table(const std::array<std::string_view, N> &keys, bool full) {
+  constexpr std::size_t max_size = next_pow2(64 * N);
+  std::uint32_t used[max_size] = {}; /* last attempt that took the slot */
+  std::uint32_t attempt = 0;
+
+  for (std::size_t size = next_pow2(N); size <= max_size; size *= 2) {
+    for (std::uint32_t seed = 1; seed <= 1024; seed++) {
+      bool ok = true;
+      attempt++;
+      for (std::size_t i = 0; i < N && ok; i++) {
+        std::size_t s =
+            key_hash(keys[i].data(), keys[i].size(), seed, full) & (size - 1);
+        ok = used[s] != attempt;
+        used[s] = attempt;
+      }
+      if (ok) {
+        return table_params{size, seed};
+      }
+    }
+  }
+  return table_params{0, 0};
+}
+
+template <typename F, std::size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)>
+keys_of(const F &f, std::index_sequence<I...>) {
+  return {{std::get<I>(f).key...}};
+}
+
+template <typename T> struct is_vector : std::false_type {};
+template <typename T, typename A>
+struct is_vector<std::vector<T, A>> : std::true_type {};
+
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T, typename = void> struct has_schema : std::false_type {};
+template <typename T>
+struct has_schema<T, std::void_t<decltype(schema<T>::fields)>>
+    : std::true_type {};
+
+template <typename M>
+jsmnint_t decode_value(const char *js, const jsmntok_t *tokens, jsmnint_t i,
+                       M &out);
+
+/**
+ * Lookup table and member decoders generated from schema<T>.
+ */
+template <typename T> struct binding {
+  static constexpr auto &fields = schema<T>::fields;
+  static constexpr std::size_t count =
+      std::tuple_size<std::remove_const_t<
+          std::remove_reference_t<decltype(fields)>>>::value;
+  static constexpr std::array<std::string_view, count> keys =
+      keys_of(fields, std::make_index_sequence<count>());
+  static_assert(unique_keys(keys, false), "jsmn::schema has a repeated key");
+
+  static constexpr bool full = !unique_keys(keys, true);
+  static constexpr table_params table = find_table(keys, full);
+  static_assert(table.size != 0, "too many keys in a jsmn::schema");
+  static constexpr std::size_t size = table.size;
+  static constexpr std::uint32_t seed = table.seed;
+
+  template <std::size_t I>
+  static bool key_is(const char *key, std::size_t len) {
+    constexpr std::string_view k = std::get<I>(fields).key;
+    return len == k.size() && std::memcmp(key, k.data(), k.size()) == 0;
+  }
+
+  /* Decodes the value at token i if the key is the one of member I, or skips
+   * it. The comparison with a key of known length is inlined. */
+  template <std::size_t I>
+  static jsmnint_t decode_member(const char *key, std::size_t len,
+                                 const char *js, const jsmntok_t *tokens,
+                                 jsmnint_t i, T &out) {
+    if (!key_is<I>(key, len)) {
+      return skip(tokens, i);
+    }
+    return decode_value(js, tokens, i, out.*(std::get<I>(fields).member));
+  }
+
+  static jsmnint_t skip_member(const char *, std::size_t, const char *,
+                               const jsmntok_t *tokens, jsmnint_t i, T &) {
+    return skip(tokens, i);
+  }
+
+  using decoder = jsmnint_t (*)(const char *, std::size_t, const char *,
+                                const jsmntok_t *, jsmnint_t, T &);
+
+  /* Decoder of every hash value: the member whose key hashes to it, or a
+   * skip for empty slots, so a key costs one hash and one indirect call */
+  template <std::size_t... I>
+  static constexpr std::array<decoder, size>
+  make_decoders(std::index_sequence<I...>) {
+    std::array<decoder, size> decoders{};
+    constexpr decoder members[] = {&decode_member<I>..., &skip_member};
+    for (std::size_t s = 0; s < size; s++) {
+      decoders[s] = &skip_member;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+      decoders[key_hash(keys[i].data(), keys[i].size(), seed, full) &
+               (size - 1)] = members[i];
+    }
+    return decoders;
+  }
+  static constexpr std::array<decoder, size> decoders =
+      make_decoders(std::make_index_sequence<count>());
+
+  static jsmnint_t decode(const char *key, std::size_t len, const char *js,
+                          const jsmntok_t *tokens, jsmnint_t i, T &out) {
+    return decoders[key_hash(key, len, seed, full) & (size - 1)](
+        key, len, js, tokens, i, out);
+  }
+};
+
+template <typename T>
+jsmnint_t decode_object(const char *js, const jsmntok_t *tokens, jsmnint_t i,
+                        T &out) {
+  using b = binding<T>;
+  jsmnint_t n, k = i + 1;
+
+  if (tokens[i].type != JSMN_OBJECT) {
+    return JSMN_ERROR_INVAL;
+  }
+  for (n = 0; n < static_cast<jsmnint_t>(tokens[i].size); n++) {
+    const char *key = js + tokens[k].start;
+    std::size_t len =
+        static_cast<std::size_t>(tokens[k].end - tokens[k].start);
+    /* Unknown keys are skipped with everything nested in their values */
+    k = b::decode(key, len, js, tokens, k + 1, out);
+    if (k < 0) {
+      return k;
+    }
+  }
+  return k;
+}
+
+template <typename M>
+jsmnint_t decode_value(const char *js, const jsmntok_t *tokens, jsmnint_t i,
+                       M &out) {
+  const jsmntok_t *tok = &tokens[i];
+
+  if constexpr (is_scalar_v<M>) {
+    int r = convert(js, tok, out);
+    if (r < 0) {
+      return r;
+    }
+  } else if constexpr (is_optional<M>::value) {
+    if (tok->type == JSMN_PRIMITIVE && js[tok->start] == 'n') {
+      out.reset();
+      return i + 1;
+    }
+    return decode_value(js, tokens, i, out.emplace());
+  } else if constexpr (is_vector<M>::value) {
+    jsmnint_t k = i + 1;
+    if (tok->type != JSMN_ARRAY) {
+      return JSMN_ERROR_INVAL;
+    }
+    out.resize(static_cast<std::size_t>(tok->size));
+    for (auto &e : out) {
+      k = decode_value(js, tokens, k, e);
+      if (k < 0) {
+        return k;
+      }
+    }
+    return k;
+  } else {
+    static_assert(has_schema<M>::value, "no jsmn::schema for a member type");
+    return decode_object(js, tokens, i, out);
+  }
+  return i + 1;
+}
+
+} /* namespace detail */
+
+/**
+ * Decode the value at token index i into out. Members of structs missing from
+ * the JSON object keep their values, unknown keys are skipped. Returns the
+ * index of the first token after the value, JSMN_ERROR_INVAL if a value has
+ * the wrong type, or JSMN_ERROR_RANGE if a number doesn't fit its member.
+ */
+template <typename T>
+jsmnint_t decode(const char *js, const jsmntok_t *tokens, jsmnint_t i,
+                 T &out) {
+  return detail::decode_value(js, tokens, i, out);
+}
+
+/**
+ * Parse a JSON string and decode it into out. Returns the number of tokens
+ * used or an error.
+ */
+template <typename T>
+jsmnint_t parse(const char *js, std::size_t len, jsmntok_t *tokens,
+                jsmnuint_t num_tokens, T &out) {
+  jsmn_parser parser;
+  jsmnint_t r, k;
+
+  jsmn_init(&parser);
+  r = jsmn_parse(&parser, js, len, tokens, num_tokens);
+  if (r == 0) {
+    return JSMN_ERROR_PART;
+  }
+  if (r < 0) {
+    return r;
+  }
+  k = detail::decode_value(js, tokens, 0, out);
+  return k < 0 ? k : r;
+}
+
+} /* namespace jsmn */
+
+#endif /* JSMN_BIND_HPP */
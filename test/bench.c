@@ -0,0 +1,682 @@
+#define _POSIX_C_SOURCE 200809L
+#include "../jsmn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Throughput of jsmn_parse() over generated JSON, for the build mode the file
+ * is compiled in (see "make bench"). Every corpus is built in memory from a
+ * fixed seed, minified and pretty-printed, and parsed both into tokens and
+ * with NULL tokens (counting only). Each case runs several times; the median
+ * gives MB/s and millions of tokens per second, the interquartile range
+ * relative to the median shows how stable the numbers are.
+ *
+ * Usage: bench [-n runs] [-s KiB] [-b baseline] [-t percent]
+ *
+ * The values of the minified corpora are also written back with jsmn_writer
+ * ("write") and, for comparison, with snprintf() and a loop escaping strings
+ * byte by byte ("printf"). Values are decoded beforehand, only writing is
+ * timed; MB/s are of the text written. "patch" writes the parsed text again
+ * with the last value replaced, copying the rest as it is.
+ *
+ * The output can be saved and passed back with -b: cases more than -t percent
+ * (default 10) slower than in the baseline are marked and the exit status
+ * is 1.
+ */
+
+#define MAX_CASES 64
+
+struct buf {
+  char *data;
+  size_t len;
+  size_t cap;
+};
+
+struct result {
+  char mode[64];
+  char corpus[32];
+  char method[16];
+  double mbps;
+};
+
+static unsigned long seed = 12345;
+
+static unsigned long rnd(unsigned long n) {
+  seed = (seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+  return (seed >> 8) % n;
+}
+
+static void put(struct buf *b, const char *s) {
+  size_t n = strlen(s);
+  if (b->len + n + 1 > b->cap) {
+    b->cap = (b->len + n + 1) * 2;
+    b->data = realloc(b->data, b->cap);
+    if (b->data == NULL) {
+      fprintf(stderr, "out of memory\n");
+      exit(2);
+    }
+  }
+  memcpy(b->data + b->len, s, n + 1);
+  b->len += n;
+}
+
+static void put_int(struct buf *b, long v) {
+  char tmp[32];
+  sprintf(tmp, "%ld", v);
+  put(b, tmp);
+}
+
+static void put_words(struct buf *b, unsigned long n) {
+  static const char *words[] = {"json",       "parser",
+                                "token",      "fast",
+                                "the",        "of",
+                                "a",          "stream",
+                                "caf\\u00e9", "\\\"quoted\\\"",
+                                "line\\n",    "\\ud83d\\ude00"};
+  unsigned long i;
+  for (i = 0; i < n; i++) {
+    if (i > 0) {
+      put(b, " ");
+    }
+    put(b, words[rnd(sizeof(words) / sizeof(words[0]))]);
+  }
+}
+
+/* An API response with an array of status objects */
+static void gen_twitter(struct buf *b, size_t size) {
+  long n = 0;
+  put(b, "{\"statuses\":[");
+  while (b->len < size) {
+    if (n > 0) {
+      put(b, ",");
+    }
+    put(b, "{\"id\":2500");
+    put_int(b, 100000000L + n);
+    put(b, ",\"created_at\":\"Mon Sep 24 03:35:21 +0000 2012\",\"text\":\"");
+    put_words(b, 5 + rnd(20));
+    put(b, "\",\"user\":{\"id\":");
+    put_int(b, (long)rnd(1000000000));
+    put(b, ",\"name\":\"");
+    put_words(b, 2);
+    put(b, "\",\"followers_count\":");
+    put_int(b, (long)rnd(100000));
+    put(b, ",\"verified\":");
+    put(b, rnd(2) ? "true" : "false");
+    put(b, ",\"profile_image_url\":\"http://a0.twimg.com/profile_images/");
+    put_int(b, (long)rnd(1000000));
+    put(b, "/normal.png\"},\"entities\":{\"hashtags\":[{\"text\":\"");
+    put_words(b, 1);
+    put(b, "\",\"indices\":[");
+    put_int(b, (long)rnd(70));
+    put(b, ",");
+    put_int(b, 70 + (long)rnd(70));
+    put(b, "]}],\"urls\":[]},\"retweet_count\":");
+    put_int(b, (long)rnd(1000));
+    put(b, ",\"favorited\":false,\"coordinates\":null,\"lang\":\"en\"}");
+    n++;
+  }
+  put(b, "],\"search_metadata\":{\"count\":");
+  put_int(b, n);
+  put(b, "}}");
+}
+
+/* An array of integers and floating point numbers */
+static void gen_numbers(struct buf *b, size_t size) {
+  char tmp[64];
+  put(b, "[");
+  while (b->len < size) {
+    if (b->len > 1) {
+      put(b, ",");
+    }
+    switch (rnd(3)) {
+    case 0:
+      put_int(b, (long)rnd(2000000) - 1000000);
+      break;
+    case 1:
+      sprintf(tmp, "%lu.%03lu", rnd(1000), rnd(1000));
+      put(b, tmp);
+      break;
+    default:
+      sprintf(tmp, "-%lu.%lue-%lu", rnd(10), rnd(100000), rnd(300));
+      put(b, tmp);
+      break;
+    }
+  }
+  put(b, "]");
+}
+
+/* An array of long strings with some escape sequences */
+static void gen_strings(struct buf *b, size_t size) {
+  put(b, "[");
+  while (b->len < size) {
+    if (b->len > 1) {
+      put(b, ",");
+    }
+    put(b, "\"");
+    put_words(b, 30 + rnd(300));
+    put(b, "\"");
+  }
+  put(b, "]");
+}
+
+/* An array of deeply nested objects and arrays */
+static void gen_deep(struct buf *b, size_t size) {
+  unsigned long i, levels = 50;
+#ifdef JSMN_MAX_DEPTH
+  if (2 * levels + 1 > JSMN_MAX_DEPTH) {
+    levels = (JSMN_MAX_DEPTH - 1) / 2;
+  }
+#endif
+  put(b, "[");
+  while (b->len < size) {
+    if (b->len > 1) {
+      put(b, ",");
+    }
+    for (i = 0; i < levels; i++) {
+      put(b, "{\"a\":[");
+    }
+    put_int(b, (long)rnd(100));
+    for (i = 0; i < levels; i++) {
+      put(b, "]}");
+    }
+  }
+  put(b, "]");
+}
+
+/* A single object with many keys */
+static void gen_wide(struct buf *b, size_t size) {
+  long n = 0;
+  put(b, "{");
+  while (b->len < size) {
+    if (n > 0) {
+      put(b, ",");
+    }
+    put(b, "\"key");
+    put_int(b, n);
+    put(b, "\":");
+    switch (n % 3) {
+    case 0:
+      put_int(b, (long)rnd(1000000));
+      break;
+    case 1:
+      put(b, "\"value\"");
+      break;
+    default:
+      put(b, "true");
+      break;
+    }
+    n++;
+  }
+  put(b, "}");
+}
+
+/* Reformats minified JSON with line breaks and two-space indentation */
+static void pretty(struct buf *out, const struct buf *in) {
+  size_t i, k;
+  int depth = 0, instring = 0, escape = 0;
+  char c[2] = {0, 0};
+
+  for (i = 0; i < in->len; i++) {
+    c[0] = in->data[i];
+    if (instring) {
+      if (escape) {
+        escape = 0;
+      } else if (c[0] == '\\') {
+        escape = 1;
+      } else if (c[0] == '\"') {
+        instring = 0;
+      }
+      put(out, c);
+      continue;
+    }
+    switch (c[0]) {
+    case '\"':
+      instring = 1;
+      put(out, c);
+      break;
+    case '{':
+    case '[':
+      put(out, c);
+      if (in->data[i + 1] == '}' || in->data[i + 1] == ']') {
+        break;
+      }
+      depth++;
+      put(out, "\n");
+      for (k = 0; k < (size_t)depth; k++) {
+        put(out, "  ");
+      }
+      break;
+    case '}':
+    case ']':
+      if (in->data[i - 1] != '{' && in->data[i - 1] != '[') {
+        depth--;
+        put(out, "\n");
+        for (k = 0; k < (size_t)depth; k++) {
+          put(out, "  ");
+        }
+      }
+      put(out, c);
+      break;
+    case ',':
+      put(out, ",\n");
+      for (k = 0; k < (size_t)depth; k++) {
+        put(out, "  ");
+      }
+      break;
+    case ':':
+      put(out, ": ");
+      break;
+    default:
+      put(out, c);
+      break;
+    }
+  }
+}
+
+/* A value to write, JSMN_UNDEFINED closes the innermost object or array */
+struct item {
+  jsmntype_t type;
+  int key;
+  const char *str; /* decoded string or literal */
+  size_t len;
+  double number;
+};
+
+/* Decodes the values of parsed tokens in the order they are written */
+static size_t decode_items(const char *js, const jsmntok_t *tokens,
+                           jsmnint_t count, struct item *items, char *strings,
+                           jsmnint_t *left, jsmntype_t *type) {
+  size_t n = 0;
+  jsmnint_t i, top = 0;
+
+  for (i = 0; i < count; i++) {
+    const jsmntok_t *t = &tokens[i];
+    struct item *it = &items[n++];
+    it->type = t->type;
+    it->key = top > 0 && type[top - 1] == JSMN_OBJECT;
+    it->str = js + t->start;
+    it->len = (size_t)(t->end - t->start);
+    it->number = 0;
+    if (t->type == JSMN_STRING) {
+      it->len = (size_t)jsmn_unescape(js, t, strings, (size_t)-1);
+      it->str = strings;
+      strings += it->len;
+    } else if (t->type == JSMN_PRIMITIVE &&
+               jsmn_tok_to_double(js, t, &it->number) == 0) {
+      it->str = NULL;
+    }
+    if (top > 0) {
+      left[top - 1]--;
+    }
+    if (t->type == JSMN_OBJECT || t->type == JSMN_ARRAY || t->size > 0) {
+      left[top] = (jsmnint_t)t->size;
+      type[top++] = t->type;
+    }
+    while (top > 0 && left[top - 1] == 0) {
+      if (type[--top] != JSMN_STRING) {
+        items[n].type = JSMN_UNDEFINED;
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+static void write_items(jsmn_writer *w, const struct item *items, size_t n) {
+  size_t i;
+  int close[256]; /* deeper than any corpus */
+  int depth = 0;
+
+  for (i = 0; i < n; i++) {
+    const struct item *it = &items[i];
+    switch (it->type) {
+    case JSMN_OBJECT:
+      jsmn_write_begin_object(w);
+      close[depth++] = 1;
+      break;
+    case JSMN_ARRAY:
+      jsmn_write_begin_array(w);
+      close[depth++] = 0;
+      break;
+    case JSMN_UNDEFINED:
+      if (close[--depth]) {
+        jsmn_write_end_object(w);
+      } else {
+        jsmn_write_end_array(w);
+      }
+      break;
+    case JSMN_STRING:
+      if (it->key) {
+        jsmn_write_key(w, it->str, it->len);
+      } else {
+        jsmn_write_string(w, it->str, it->len);
+      }
+      break;
+    default:
+      if (it->str == NULL) {
+        jsmn_write_double(w, it->number);
+      } else {
+        jsmn_write_raw(w, it->str, it->len);
+      }
+      break;
+    }
+  }
+}
+
+/* What writing JSON with snprintf() usually looks like */
+static size_t printf_items(char *out, size_t size, const struct item *items,
+                           size_t n) {
+  size_t i, k, len = 0;
+  char close[256];
+  int depth = 0, comma = 0;
+
+  for (i = 0; i < n; i++) {
+    const struct item *it = &items[i];
+    if (it->type == JSMN_UNDEFINED) {
+      out[len++] = close[--depth];
+      comma = 1;
+      continue;
+    }
+    if (comma) {
+      out[len++] = ',';
+    }
+    comma = 1;
+    switch (it->type) {
+    case JSMN_OBJECT:
+    case JSMN_ARRAY:
+      out[len++] = it->type == JSMN_OBJECT ? '{' : '[';
+      close[depth++] = it->type == JSMN_OBJECT ? '}' : ']';
+      comma = 0;
+      break;
+    case JSMN_STRING:
+      out[len++] = '\"';
+      for (k = 0; k < it->len; k++) {
+        unsigned char c = (unsigned char)it->str[k];
+        if (c == '\"' || c == '\\') {
+          out[len++] = '\\';
+          out[len++] = (char)c;
+        } else if (c < 0x20) {
+          len += (size_t)snprintf(out + len, size - len, "\\u%04x", c);
+        } else {
+          out[len++] = (char)c;
+        }
+      }
+      out[len++] = '\"';
+      if (it->key) {
+        out[len++] = ':';
+        comma = 0;
+      }
+      break;
+    default:
+      if (it->str == NULL) {
+        len += (size_t)snprintf(out + len, size - len, "%.17g", it->number);
+      } else {
+        memcpy(out + len, it->str, it->len);
+        len += it->len;
+      }
+      break;
+    }
+  }
+  return len;
+}
+
+static const char *mode_name(void) {
+  static char name[64];
+  name[0] = '\0';
+#ifdef JSMN_STRICT
+  strcat(name, "+strict");
+#endif
+#ifdef JSMN_PARENT_LINKS
+  strcat(name, "+links");
+#endif
+#ifdef JSMN_MAX_DEPTH
+  strcat(name, "+stack");
+#endif
+#ifdef JSMN_SIMD
+  strcat(name, "+simd");
+#endif
+#ifdef JSMN_SKIP_LINKS
+  strcat(name, "+skip_links");
+#endif
+#ifdef JSMN_COMPACT
+  strcat(name, "+compact");
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+  strcat(name, "+escape_flags");
+#endif
+#ifdef JSMN_LARGE
+  strcat(name, "+large");
+#endif
+#ifdef JSMN_STATS
+  strcat(name, "+stats");
+#endif
+  return name[0] == '\0' ? "default" : name + 1;
+}
+
+static double now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void *grow(void *user, void *ptr, size_t size) {
+  (void)user;
+  return realloc(ptr, size);
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+/* Reads results of an earlier run, lines that are not results are skipped */
+static int read_baseline(const char *path, struct result *base) {
+  char line[256];
+  int n = 0;
+  FILE *f = fopen(path, "r");
+  if (f == NULL) {
+    perror(path);
+    exit(2);
+  }
+  while (n < 8 * MAX_CASES && fgets(line, sizeof(line), f) != NULL) {
+    if (sscanf(line, "%63s %31s %15s %lf", base[n].mode, base[n].corpus,
+               base[n].method, &base[n].mbps) == 4) {
+      n++;
+    }
+  }
+  fclose(f);
+  return n;
+}
+
+/* Prints the median of sorted times and compares it with the baseline */
+static int report(const char *mode, const char *corpus, const char *method,
+                  const double *times, int runs, size_t len, double count,
+                  const struct result *base, int num_base, double threshold) {
+  double median = times[runs / 2];
+  double spread = (times[runs * 3 / 4] - times[runs / 4]) / median * 100;
+  double mbps = (double)len / median / 1e6;
+  int k, slower = 0;
+
+  printf("%-24s %-15s %-6s %9.1f %9.2f %6.1f%%", mode, corpus, method, mbps,
+         count / median / 1e6, spread);
+  for (k = 0; k < num_base; k++) {
+    if (strcmp(base[k].mode, mode) == 0 &&
+        strcmp(base[k].corpus, corpus) == 0 &&
+        strcmp(base[k].method, method) == 0) {
+      double change = (mbps / base[k].mbps - 1) * 100;
+      printf(" %+6.1f%%%s", change, change < -threshold ? " SLOWER" : "");
+      slower = change < -threshold;
+      break;
+    }
+  }
+  printf("\n");
+  fflush(stdout);
+  return slower;
+}
+
+int main(int argc, char *argv[]) {
+  static struct result base[8 * MAX_CASES];
+  struct buf corpus[10];
+  const char *names[10] = {"twitter",        "twitter_pretty", "numbers",
+                           "numbers_pretty", "strings",        "strings_pretty",
+                           "deep",           "deep_pretty",    "wide",
+                           "wide_pretty"};
+  void (*gen[5])(struct buf *, size_t) = {gen_twitter, gen_numbers,
+                                          gen_strings, gen_deep, gen_wide};
+  const char *mode = mode_name();
+  int runs = 11, num_base = 0, slower = 0;
+  double threshold = 10;
+  size_t size = 256;
+  double *times;
+  int i, j, m;
+
+  for (i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "-n") == 0) {
+      runs = atoi(argv[i + 1]);
+    } else if (strcmp(argv[i], "-s") == 0) {
+      size = (size_t)atol(argv[i + 1]);
+    } else if (strcmp(argv[i], "-b") == 0) {
+      num_base = read_baseline(argv[i + 1], base);
+    } else if (strcmp(argv[i], "-t") == 0) {
+      threshold = atof(argv[i + 1]);
+    } else {
+      break;
+    }
+  }
+  if (i < argc || runs < 1 || size == 0) {
+    fprintf(stderr, "usage: %s [-n runs] [-s KiB] [-b baseline] [-t percent]\n",
+            argv[0]);
+    return 2;
+  }
+  times = malloc((size_t)runs * sizeof(*times));
+
+  memset(corpus, 0, sizeof(corpus));
+  for (i = 0; i < 5; i++) {
+    struct buf tmp = {NULL, 0, 0};
+    gen[i](&corpus[2 * i], size * 1024);
+    pretty(&corpus[2 * i + 1], &corpus[2 * i]);
+    /* Indentation of deep nesting takes more than the data itself, pretty
+     * corpora are generated smaller to end up about the same size */
+    if (corpus[2 * i + 1].len > 2 * corpus[2 * i].len) {
+      seed = 12345;
+      gen[i](&tmp, size * 1024 / (corpus[2 * i + 1].len / corpus[2 * i].len));
+      corpus[2 * i + 1].len = 0;
+      pretty(&corpus[2 * i + 1], &tmp);
+      free(tmp.data);
+    }
+  }
+
+  printf("# %-22s %-15s %-6s %9s %9s %7s\n", "mode", "corpus", "method",
+         "MB/s", "Mtok/s", "spread");
+  for (i = 0; i < 10; i++) {
+    const char *js = corpus[i].data;
+    size_t len = corpus[i].len;
+    jsmn_parser p;
+    jsmntok_t *tokens;
+    jsmnint_t count;
+
+    jsmn_init(&p);
+    count = jsmn_parse(&p, js, len, NULL, 0);
+    if (count <= 0) {
+      fprintf(stderr, "%s: error %d\n", names[i], (int)count);
+      return 2;
+    }
+    tokens = malloc((size_t)count * sizeof(*tokens));
+    if (times == NULL || tokens == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return 2;
+    }
+
+    for (m = 0; m < 2; m++) {
+      double t;
+      /* The first run only warms up caches */
+      for (j = -1; j < runs; j++) {
+        jsmn_init(&p);
+        t = now();
+        if (jsmn_parse(&p, js, len, m == 0 ? tokens : NULL,
+                       m == 0 ? (jsmnuint_t)count : 0) != count) {
+          fprintf(stderr, "%s: wrong token count\n", names[i]);
+          return 2;
+        }
+        t = now() - t;
+        if (j >= 0) {
+          times[j] = t;
+        }
+      }
+      qsort(times, (size_t)runs, sizeof(*times), cmp_double);
+      slower |= report(mode, names[i], m == 0 ? "tokens" : "count", times,
+                       runs, len, (double)count, base, num_base, threshold);
+    }
+
+    if (i % 2 == 0) {
+      unsigned int depth;
+      size_t num_items, out_len = 0, out_size;
+      struct item *items = malloc(2 * (size_t)count * sizeof(*items));
+      char *strings = malloc(len);
+      jsmnint_t *left;
+      jsmntype_t *type;
+      jsmn_writer w;
+      jsmn_patch edit = {JSMN_PATCH_REPLACE, 0, NULL, 0, "0", 1, 0, 0};
+
+      jsmn_measure(js, len, &depth);
+      left = malloc((2 * (size_t)depth + 1) * sizeof(*left));
+      type = malloc((2 * (size_t)depth + 1) * sizeof(*type));
+      if (items == NULL || strings == NULL || left == NULL || type == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+      }
+      num_items = decode_items(js, tokens, count, items, strings, left, type);
+      /* Every byte may become an escape, every number 24 bytes */
+      out_size = 6 * len + 24 * (size_t)count;
+      jsmn_writer_init(&w, malloc(out_size), out_size, grow, NULL);
+
+      edit.token = count - 1;
+
+      for (m = 0; m < 3; m++) {
+        double t;
+        for (j = -1; j < runs; j++) {
+          t = now();
+          if (m == 0) {
+            w.len = 0;
+            write_items(&w, items, num_items);
+            out_len = w.len;
+          } else if (m == 1) {
+            out_len = printf_items(w.buf, out_size, items, num_items);
+          } else {
+            w.len = 0;
+            w.comma = 0;
+            jsmn_write_patched(&w, js, tokens, count, &edit, 1);
+            out_len = w.len;
+          }
+          t = now() - t;
+          if (j >= 0) {
+            times[j] = t;
+          }
+          if (w.error != 0 || w.depth != 0) {
+            fprintf(stderr, "%s: writer error %d\n", names[i], w.error);
+            return 2;
+          }
+        }
+        qsort(times, (size_t)runs, sizeof(*times), cmp_double);
+        slower |= report(mode, names[i],
+                         m == 0 ? "write" : m == 1 ? "printf" : "patch", times,
+                         runs, out_len, (double)num_items, base, num_base,
+                         threshold);
+      }
+      free(w.buf);
+      free(items);
+      free(strings);
+      free(left);
+      free(type);
+    }
+    free(tokens);
+  }
+
+  for (i = 0; i < 10; i++) {
+    free(corpus[i].data);
+  }
+  free(times);
+  return slower;
+}
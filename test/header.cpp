@@ -0,0 +1,27 @@
+/*
+ * A second translation unit of the C++ tests. It sees only declarations of
+ * the jsmn_* functions, their definitions come from tests.cpp.
+ */
+#define JSMN_HEADER
+#include "../jsmn_bind.hpp"
+
+struct origin {
+  int x = 0;
+  int y = 0;
+};
+
+template <> struct jsmn::schema<origin> {
+  static constexpr auto fields =
+      jsmn::fields(JSMN_MEMBER(origin, x), JSMN_MEMBER(origin, y));
+};
+
+/* Decodes js into x and y, then reads y again through a view */
+jsmnint_t decode_origin(const char *js, int *x, int *y) {
+  jsmntok_t t[8];
+  origin o;
+  jsmnint_t r = jsmn::parse(js, strlen(js), t, 8, o);
+
+  *x = o.x;
+  *y = r > 0 ? jsmn::document(js, t, r).root()["y"].as<int>() : 0;
+  return r;
+}
@@ -1,3 +1,10 @@
+#if defined(JSMN_LARGE) && defined(__unix__) && defined(__LP64__)
+#define _DEFAULT_SOURCE /* mmap() and MAP_ANONYMOUS in strict C modes */
+#define TEST_LARGE_INPUT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <locale.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -96,6 +103,48 @@ int test_string(void) {
   return 0;
 }
 
+int test_long_string(void) {
+  int i, j;
+  jsmn_parser p;
+  jsmntok_t tok[2];
+  char js[80];
+
+  /* Escapes, quotes and NULs at every offset of a vector-sized block */
+  for (i = 0; i < 70; i++) {
+    memset(js, 'x', sizeof(js));
+    js[0] = '[';
+    js[1] = '\"';
+    js[2 + i] = '\"';
+    js[3 + i] = ']';
+    jsmn_init(&p);
+    check(jsmn_parse(&p, js, 4 + i, tok, 2) == 2);
+    check(tok[1].type == JSMN_STRING);
+    check(tok[1].start == 2 && tok[1].end == 2 + i);
+
+    for (j = 2; j < 2 + i - 1; j++) {
+      js[j] = '\\';
+      js[j + 1] = 'n';
+      jsmn_init(&p);
+      check(jsmn_parse(&p, js, 4 + i, tok, 2) == 2);
+      check(tok[1].start == 2 && tok[1].end == 2 + i);
+
+      js[j + 1] = 'q';
+      jsmn_init(&p);
+      check(jsmn_parse(&p, js, 4 + i, tok, 2) == JSMN_ERROR_INVAL);
+
+      js[j] = '\0';
+      js[j + 1] = 'x';
+      jsmn_init(&p);
+      check(jsmn_parse(&p, js, 4 + i, tok, 2) == JSMN_ERROR_PART);
+      js[j] = 'x';
+    }
+
+    jsmn_init(&p);
+    check(jsmn_parse(&p, js, 2 + i, tok, 2) == JSMN_ERROR_PART);
+  }
+  return 0;
+}
+
 int test_partial_string(void) {
   int r;
   unsigned long i;
@@ -118,6 +167,38 @@ int test_partial_string(void) {
   return 0;
 }
 
+int test_partial_resume(void) {
+  int r;
+  unsigned long i;
+  jsmn_parser p;
+  jsmntok_t tok[4];
+  const char *js = "[\"long string \\u00e9\\n\\\\ with escapes\"]";
+
+  /* Strings cut off by the end of input are continued from where the previous
+   * call stopped rather than scanned again */
+  jsmn_init(&p);
+  for (i = 1; i <= strlen(js); i++) {
+    r = jsmn_parse(&p, js, i, tok, 4);
+    if (i == strlen(js)) {
+      check(r == 2);
+      check(tokeq(js, tok, 2, JSMN_ARRAY, -1, -1, 1, JSMN_STRING,
+                  "long string \\u00e9\\n\\\\ with escapes", 0));
+    } else {
+      check(r == JSMN_ERROR_PART);
+      if (i > 2 && i < strlen(js) - 1) {
+        check(p.tokstart == 1 && p.pos == i);
+      }
+    }
+  }
+
+  /* Running out of tokens keeps the position at the closing quote */
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), tok, 1) == JSMN_ERROR_NOMEM);
+  check(p.tokstart == 1 && js[p.pos] == '\"');
+  check(jsmn_parse(&p, js, strlen(js), tok, 4) == 2);
+  return 0;
+}
+
 int test_partial_array(void) {
 #ifdef JSMN_STRICT
   int r;
@@ -169,6 +250,37 @@ int test_array_nomem(void) {
   return 0;
 }
 
+static void *test_grow(void *user, void *ptr, size_t size) {
+  (*(int *)user)++;
+  return realloc(ptr, size);
+}
+
+int test_array_realloc(void) {
+  int i;
+  int r;
+  int grown = 0;
+  jsmnuint_t n = 0;
+  jsmn_parser p;
+  jsmntok_t *tok = NULL;
+  char js[512];
+
+  strcpy(js, "[");
+  for (i = 0; i < 20; i++) {
+    strcat(js, i == 0 ? "{\"a\": \"b\"}" : ", {\"a\": \"b\"}");
+  }
+  strcat(js, "]");
+
+  jsmn_init(&p);
+  r = jsmn_parse_realloc(&p, js, strlen(js), &tok, &n, test_grow, &grown);
+  check(r == 61 && grown == 3 && n == 64);
+  check(tokeq(js, tok, 4, JSMN_ARRAY, -1, -1, 20, JSMN_OBJECT, -1, -1, 1,
+              JSMN_STRING, "a", 1, JSMN_STRING, "b", 0));
+  check(tokeq(js, tok + 58, 3, JSMN_OBJECT, -1, -1, 1, JSMN_STRING, "a", 1,
+              JSMN_STRING, "b", 0));
+  free(tok);
+  return 0;
+}
+
 int test_unquoted_keys(void) {
 #ifndef JSMN_STRICT
   int r;
@@ -336,16 +448,1128 @@ int test_object_key(void) {
   return 0;
 }
 
+int test_max_depth(void) {
+#ifdef JSMN_MAX_DEPTH
+  int i;
+  jsmn_parser p;
+  jsmntok_t tok[JSMN_MAX_DEPTH + 2];
+  char js[2 * JSMN_MAX_DEPTH + 3];
+
+  for (i = 0; i < JSMN_MAX_DEPTH; i++) {
+    js[i] = '[';
+    js[JSMN_MAX_DEPTH + i] = ']';
+  }
+  js[2 * JSMN_MAX_DEPTH] = '\0';
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), tok, JSMN_MAX_DEPTH + 2) ==
+        JSMN_MAX_DEPTH);
+  check(tok[0].start == 0 && tok[0].end == 2 * JSMN_MAX_DEPTH);
+  check(tok[JSMN_MAX_DEPTH - 1].size == 0);
+
+  for (i = 0; i <= JSMN_MAX_DEPTH; i++) {
+    js[i] = '[';
+    js[JSMN_MAX_DEPTH + 1 + i] = ']';
+  }
+  js[2 * JSMN_MAX_DEPTH + 2] = '\0';
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), tok, JSMN_MAX_DEPTH + 2) ==
+        JSMN_ERROR_DEPTH);
+#endif
+  return 0;
+}
+
+int test_large_size(void) {
+  int i;
+  jsmn_parser p;
+  jsmntok_t *t = malloc(1002 * sizeof(jsmntok_t));
+  char *js = malloc(2 * 1000 + 3);
+
+  js[0] = '[';
+  for (i = 0; i < 1000; i++) {
+    js[1 + 2 * i] = '0';
+    js[2 + 2 * i] = ',';
+  }
+  js[2 * 1000] = ']';
+  js[2 * 1000 + 1] = '\0';
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), t, 1002) == 1001);
+  check(t[0].type == JSMN_ARRAY && t[0].size == 1000);
+  check(t[1000].type == JSMN_PRIMITIVE && t[1000].start == 1999);
+#ifdef JSMN_COMPACT
+  {
+    /* The last child of an array at the limit, then one more */
+    static const char *const more[] = {"[0,0,1]", "[0,0,\"a\"]", "[0,0,[]]"};
+    for (i = 0; i < 3; i++) {
+      jsmn_init(&p);
+      check(jsmn_parse(&p, more[i], 3, t, 8) == JSMN_ERROR_PART);
+      t[0].size = JSMN_MAX_SIZE - 1;
+      check(jsmn_parse(&p, more[i], strlen(more[i]), t, 8) ==
+            JSMN_ERROR_RANGE);
+      check(t[0].size == JSMN_MAX_SIZE);
+    }
+  }
+#endif
+  free(js);
+  free(t);
+  return 0;
+}
+
+int test_structurals(void) {
+  static const char *inputs[] = {
+      "{\"a\": [1, 2.5e3, true, null], \"b\": {\"c\": \"d\"}}",
+      "{\n    \"key\": \"value with spaces and \\\" quotes\",\n"
+      "    \"array\": [\n        {},\n        []\n    ]\n}\n",
+      "[\"\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\", \"x\"]",
+      "[\"0123456789012345678901234567\\\\\\\"\", 1]",
+      "[\"01234567890123456789012345678\\\\\", \"y\"]",
+      "[\"\\u00e9\\uD83D\\uDE00\", \"{[:,]}\", -0.5]",
+      "{\"a\": 1]",
+      "{\"a\": [1, 2}",
+      "{\"a\": \"unterminated",
+      "{\"a\":\"b\"}\0{\"c\":1}",
+      "[1, 2, 3",
+      "  ",
+      "",
+      "key1: \"value\"\nkey2 : 123",
+      "[ab\"c\", \"d\"]",
+      "[a\\\"b, \"c\"]",
+      "{\"a\" : tru\"e\"}",
+      "[1x, \"s\"\"t\", {}]"};
+  jsmnuint_t n;
+  jsmnuint_t indices[256];
+  jsmntok_t tok1[64], tok2[64];
+  jsmn_parser p1, p2;
+  int r1, r2, k;
+  size_t i, len;
+
+  for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    len = strlen(inputs[i]);
+    if (i == 9) {
+      len += 8;
+    }
+    r1 = jsmn_structurals(inputs[i], len, NULL, 0);
+    check(r1 >= 0 && r1 <= 256);
+    check(jsmn_structurals(inputs[i], len, indices, 256) == r1);
+    n = (jsmnuint_t)r1;
+    if (n > 0) {
+      check(jsmn_structurals(inputs[i], len, indices, n - 1) ==
+            JSMN_ERROR_NOMEM);
+    }
+
+    jsmn_init(&p1);
+    jsmn_init(&p2);
+    r1 = jsmn_parse(&p1, inputs[i], len, tok1, 64);
+    r2 = jsmn_parse_structurals(&p2, inputs[i], len, indices, n, tok2, 64);
+    check(r1 == r2);
+    check(p1.pos == p2.pos);
+    for (k = 0; k < r1; k++) {
+      check(tok1[k].type == tok2[k].type);
+      check(tok1[k].start == tok2[k].start);
+      check(tok1[k].end == tok2[k].end);
+      check(tok1[k].size == tok2[k].size);
+    }
+
+    jsmn_init(&p1);
+    jsmn_init(&p2);
+    r1 = jsmn_parse(&p1, inputs[i], len, NULL, 0);
+    r2 = jsmn_parse_structurals(&p2, inputs[i], len, indices, n, NULL, 0);
+    check(r1 == r2);
+  }
+  return 0;
+}
+
+int test_measure(void) {
+  static const struct {
+    const char *js;
+    int count;
+    unsigned int depth;
+  } inputs[] = {
+      {"{\"a\": [1, 2.5e3, true, null], \"b\": {\"c\": \"d\"}}", 11, 2},
+      {"[[[[\"]]]]\\\"\"]]], {}]", 6, 4},
+      {"[\"0123456789012345678901234567\\\\\\\"\", -1, \"x\"]", 4, 1},
+      {"{\"a\": {\"b\": {\"c\": [[[[[[[[[[[[[[[[[[[[[[[[[[[[[["
+       "]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]}}}",
+       36, 33},
+      {"  ", 0, 0},
+      {"{\"a\":\"b\"}\0{\"c\":1}", 3, 1},
+      {"[1, 2", JSMN_ERROR_PART, 1},
+      {"{\"a\": \"unterminated]", JSMN_ERROR_PART, 1},
+      {"{\"a\": 1}}", JSMN_ERROR_INVAL, 1}};
+  int r;
+  unsigned int depth;
+  jsmn_parser p;
+  size_t i;
+
+  for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+    r = jsmn_measure(inputs[i].js, strlen(inputs[i].js) + (i == 5 ? 8 : 0),
+                     &depth);
+    check(r == inputs[i].count);
+    if (r != JSMN_ERROR_INVAL) {
+      check(depth == inputs[i].depth);
+    }
+    if (r >= 0) {
+      jsmn_init(&p);
+      check(jsmn_parse(&p, inputs[i].js, strlen(inputs[i].js), NULL, 0) == r);
+    }
+  }
+#ifdef JSMN_STRICT
+  check(jsmn_measure("123", 3, NULL) == JSMN_ERROR_PART);
+#else
+  check(jsmn_measure("123", 3, NULL) == 1);
+#endif
+  return 0;
+}
+
+int test_find_path(void) {
+  jsmntok_t t;
+  const char *js = "{\"meta\": {\"ids\": [10, {\"x\": \"y\"}, [3]], \"a/b\": "
+                   "\"slash\", \"m~n\": null}, \"trace_id\": \"abc\\\"d\", "
+                   "\"n\": -1.5e3}";
+
+  check(jsmn_find_path(js, strlen(js), "/trace_id", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_STRING, "abc\\\"d", 0));
+  check(jsmn_find_path(js, strlen(js), "/n", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_PRIMITIVE, "-1.5e3"));
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/1", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_OBJECT, 22, 32, 1));
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/1/x", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_STRING, "y", 0));
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/2/0", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_PRIMITIVE, "3"));
+  check(jsmn_find_path(js, strlen(js), "/meta/ids", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_ARRAY, 17, 38, 3));
+  check(jsmn_find_path(js, strlen(js), "/meta/a~1b", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_STRING, "slash", 0));
+  check(jsmn_find_path(js, strlen(js), "/meta/m~0n", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_PRIMITIVE, "null"));
+  check(jsmn_find_path(js, strlen(js), "", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_OBJECT, 0, (int)strlen(js), 3));
+
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/3", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/-", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/01", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/00", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/18446744073709551617",
+                       &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/ids/4294967297", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/meta/id", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "/n/0", &t) == 0);
+  check(jsmn_find_path(js, strlen(js), "trace_id", &t) == JSMN_ERROR_INVAL);
+
+  /* The parser stops as soon as the value is found */
+  js = "{\"a\": [1, 2], \"b\": \"c\"] garbage";
+  check(jsmn_find_path(js, strlen(js), "/b", &t) == 1);
+  check(tokeq(js, &t, 1, JSMN_STRING, "c", 0));
+  check(jsmn_find_path(js, strlen(js), "/c", &t) == JSMN_ERROR_INVAL);
+  js = "{\"a\": [1, 2], \"b\": \"c";
+  check(jsmn_find_path(js, strlen(js), "/a/1", &t) == 1);
+  check(jsmn_find_path(js, strlen(js), "/b", &t) == JSMN_ERROR_PART);
+  check(jsmn_find_path(js, strlen(js), "/c", &t) == JSMN_ERROR_PART);
+  js = "{\"a\": \"\\x\", \"b\": 1}";
+  check(jsmn_find_path(js, strlen(js), "/b", &t) == JSMN_ERROR_INVAL);
+
+  /* Primitives are checked like jsmn_parse() does */
+  js = "{\"a\": [1, x], \"b\": 2}";
+#ifdef JSMN_STRICT
+  check(jsmn_find_path(js, strlen(js), "/b", &t) == JSMN_ERROR_INVAL);
+  check(jsmn_find_path(js, strlen(js), "/a/1", &t) == JSMN_ERROR_INVAL);
+#else
+  check(jsmn_find_path(js, strlen(js), "/b", &t) == 1);
+  check(jsmn_find_path(js, strlen(js), "/a/1", &t) == 1);
+#endif
+
+#ifdef JSMN_ESCAPE_FLAGS
+  js = "{\"a\": {\"b\": \"\\n\"}}";
+  memset(&t, 0x55, sizeof(t));
+  check(jsmn_find_path(js, strlen(js), "/a", &t) == 1 && t.escaped == 0);
+  check(jsmn_find_path(js, strlen(js), "/a/b", &t) == 1 && t.escaped == 1);
+#endif
+  return 0;
+}
+
+int test_index(void) {
+  int i, r, k;
+  jsmn_parser p;
+  jsmn_index idx;
+  jsmnint_t slots[2048];
+  char key[16];
+  char *js = malloc(1000 * 32);
+  jsmntok_t *tok = malloc(8000 * sizeof(jsmntok_t));
+
+  strcpy(js, "{");
+  for (i = 0; i < 1000; i++) {
+    sprintf(js + strlen(js), "%s\"k%d\": %s", i == 0 ? "" : ", ", i,
+            i % 2 == 0 ? "[1, {\"k1\": 0}]" : "{\"k0\": {}}");
+  }
+  strcat(js, ", \"k7\": 7}");
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), tok, 8000);
+  check(r > 0);
+  check(jsmn_index_init(&idx, js, tok, 0, slots, 1000) == JSMN_ERROR_INVAL);
+  check(jsmn_index_init(&idx, js, tok, 0, slots, 512) == JSMN_ERROR_NOMEM);
+  check(jsmn_index_init(&idx, js, tok, 1, slots, 2048) == JSMN_ERROR_INVAL);
+  check(jsmn_index_init(&idx, js, tok, 0, slots, 2048) == 0);
+  for (i = 0; i < 1000; i++) {
+    sprintf(key, "k%d", i);
+    k = jsmn_index_find(&idx, js, tok, key, strlen(key));
+    check(k > 1 && tok[k - 1].end - tok[k - 1].start == (int)strlen(key) &&
+          strncmp(js + tok[k - 1].start, key, strlen(key)) == 0);
+    check(tok[k].type == (i % 2 == 0 ? JSMN_ARRAY : JSMN_OBJECT));
+  }
+  check(tok[jsmn_index_find(&idx, js, tok, "k7", 2)].type == JSMN_OBJECT);
+  check(jsmn_index_find(&idx, js, tok, "k1000", 5) == -1);
+  check(jsmn_index_find(&idx, js, tok, "k", 1) == -1);
+  check(jsmn_index_find(&idx, js, tok, "", 0) == -1);
+
+  /* Nested objects have their own index */
+  k = jsmn_index_find(&idx, js, tok, "k1", 2);
+  check(jsmn_index_init(&idx, js, tok, k, slots, 2) == 0);
+  check(jsmn_index_find(&idx, js, tok, "k0", 2) == k + 2);
+  check(jsmn_index_find(&idx, js, tok, "k1", 2) == -1);
+  free(js);
+  free(tok);
+  return 0;
+}
+
+int test_numbers(void) {
+  int r;
+  jsmn_parser p;
+  jsmntok_t t[16];
+  double d[8];
+  const char *js = "[0, -2.5e3, 0.1, 1e23, 2.2250738585072014e-308, "
+                   "123456789012345678901, -0, 1e400]";
+#ifdef JSMN_HAS_INT64
+  int64_t i[8];
+  uint64_t u;
+  const char *ints = "[9223372036854775807, -9223372036854775808, "
+                     "18446744073709551615, 9223372036854775808, 1.0, -1]";
+#endif
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 16);
+  check(r == 9);
+  check(jsmn_tok_to_double(js, &t[1], &d[0]) == 0 && d[0] == 0);
+  check(jsmn_tok_to_double(js, &t[2], &d[0]) == 0 && d[0] == -2500);
+  check(jsmn_tok_to_double(js, &t[3], &d[0]) == 0 && d[0] == 0.1);
+  check(jsmn_tok_to_double(js, &t[4], &d[0]) == 0 && d[0] == 1e23);
+  check(jsmn_tok_to_double(js, &t[5], &d[0]) == 0 &&
+        d[0] == 2.2250738585072014e-308);
+  check(jsmn_tok_to_double(js, &t[6], &d[0]) == 0 &&
+        d[0] == 123456789012345678901.0);
+  check(jsmn_tok_to_double(js, &t[7], &d[0]) == 0 && d[0] == 0 &&
+        1 / d[0] < 0);
+  check(jsmn_tok_to_double(js, &t[8], &d[0]) == JSMN_ERROR_RANGE);
+  check(jsmn_tok_to_double(js, &t[0], &d[0]) == JSMN_ERROR_INVAL);
+  check(jsmn_array_to_double(js, t, 0, d, 8) == JSMN_ERROR_RANGE);
+
+  t[0].size = 7;
+  check(jsmn_array_to_double(js, t, 0, d, 6) == JSMN_ERROR_NOMEM);
+  check(jsmn_array_to_double(js, t, 0, d, 8) == 7);
+  check(d[1] == -2500 && d[6] == 0);
+
+  /* Primitives that are not valid numbers */
+  js = "[01, 1., .5, -, 1e, +1, 0x10, true]";
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 16);
+#ifndef JSMN_STRICT
+  check(r == 9);
+  for (r = 1; r < 9; r++) {
+    check(jsmn_tok_to_double(js, &t[r], &d[0]) == JSMN_ERROR_INVAL);
+  }
+#endif
+
+#ifdef JSMN_HAS_INT64
+  jsmn_init(&p);
+  r = jsmn_parse(&p, ints, strlen(ints), t, 16);
+  check(r == 7);
+  check(jsmn_tok_to_int64(ints, &t[1], &i[0]) == 0 && i[0] == INT64_MAX);
+  check(jsmn_tok_to_int64(ints, &t[2], &i[0]) == 0 && i[0] == INT64_MIN);
+  check(jsmn_tok_to_int64(ints, &t[3], &i[0]) == JSMN_ERROR_RANGE);
+  check(jsmn_tok_to_int64(ints, &t[4], &i[0]) == JSMN_ERROR_RANGE);
+  check(jsmn_tok_to_int64(ints, &t[5], &i[0]) == JSMN_ERROR_INVAL);
+  check(jsmn_tok_to_uint64(ints, &t[3], &u) == 0 && u == UINT64_MAX);
+  check(jsmn_tok_to_uint64(ints, &t[4], &u) == 0 &&
+        u == (uint64_t)INT64_MAX + 1);
+  check(jsmn_tok_to_uint64(ints, &t[6], &u) == JSMN_ERROR_RANGE);
+  check(jsmn_tok_to_uint64(ints, &t[2], &u) == JSMN_ERROR_RANGE);
+
+  t[0].size = 2;
+  check(jsmn_array_to_int64(ints, t, 0, i, 8) == 2);
+  check(i[0] == INT64_MAX && i[1] == INT64_MIN);
+#endif
+  return 0;
+}
+
+int test_long_numbers(void) {
+  int r;
+  jsmn_parser p;
+  jsmntok_t t[8];
+  double d = 7;
+  char js[400];
+  const char *ties = "[9007199254740993, "
+                     "9007199254740993.0000000000000000000001, "
+                     "2.2250738585072011e-308, 4.9e-324, 1e400]";
+  const char *locales[] = {"de_DE.UTF-8", "de_DE", "fr_FR.UTF-8", "fr_FR"};
+
+  /* 1e-140 spelled out in full, then 1e129 with all of its 130 digits */
+  memset(js, '0', sizeof(js));
+  js[0] = '[';
+  js[2] = '.';
+  js[142] = '1';
+  js[143] = ',';
+  js[144] = '1';
+  js[274] = ']';
+  js[275] = '\0';
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 8);
+  check(r == 3);
+  check(t[1].end - t[1].start == 142 && t[2].end - t[2].start == 130);
+  check(jsmn_tok_to_double(js, &t[1], &d) == 0 && d == 1e-140);
+  check(jsmn_tok_to_double(js, &t[2], &d) == 0 && d == 1e129);
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, ties, strlen(ties), t, 8);
+  check(r == 6);
+  check(jsmn_tok_to_double(ties, &t[1], &d) == 0 && d == 9007199254740992.0);
+  check(jsmn_tok_to_double(ties, &t[2], &d) == 0 && d == 9007199254740994.0);
+  check(jsmn_tok_to_double(ties, &t[3], &d) == 0 &&
+        d == 2.2250738585072011e-308);
+  check(jsmn_tok_to_double(ties, &t[4], &d) == 0 && d == 4.9e-324);
+  /* Out of range leaves the value alone */
+  d = 7;
+  check(jsmn_tok_to_double(ties, &t[5], &d) == JSMN_ERROR_RANGE && d == 7);
+
+  /* The conversion ignores the decimal separator of the locale */
+  for (r = 0; r < 4 && setlocale(LC_NUMERIC, locales[r]) == NULL; r++) {
+  }
+  jsmn_init(&p);
+  js[0] = '\0';
+  strcat(js, "[1.5e300, 0.25]");
+  check(jsmn_parse(&p, js, strlen(js), t, 8) == 3);
+  check(jsmn_tok_to_double(js, &t[1], &d) == 0 && d == 1.5e300);
+  check(jsmn_tok_to_double(js, &t[2], &d) == 0 && d == 0.25);
+  setlocale(LC_NUMERIC, "C");
+  return 0;
+}
+
+int test_unescape(void) {
+  int r;
+  jsmn_parser p;
+  jsmntok_t t[8];
+  char buf[64];
+  char js[] = "[\"plain\", \"a\\\\n\\\"b\\\\\\/\", \"\\u00e9\\u20AC\\ud83d\\ude00\", "
+              "\"\\udc00\", \"\\ud83d\\u0041\", \"0123456789abcdef\\tghij\"]";
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 8);
+  check(r == 7);
+  check(jsmn_unescape(js, &t[1], buf, sizeof(buf)) == 5);
+  check(strncmp(buf, "plain", 5) == 0);
+  check(jsmn_unescape(js, &t[2], buf, sizeof(buf)) == 7);
+  check(strncmp(buf, "a\\n\"b\\/", 7) == 0);
+  check(jsmn_unescape(js, &t[3], buf, sizeof(buf)) == 9);
+  check(strncmp(buf, "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", 9) == 0);
+  check(jsmn_unescape(js, &t[3], buf, 8) == JSMN_ERROR_NOMEM);
+  /* Unpaired surrogates */
+  check(jsmn_unescape(js, &t[4], buf, sizeof(buf)) == JSMN_ERROR_INVAL);
+  check(jsmn_unescape(js, &t[5], buf, sizeof(buf)) == JSMN_ERROR_INVAL);
+  check(jsmn_unescape(js, &t[0], buf, sizeof(buf)) == JSMN_ERROR_INVAL);
+
+  /* In place */
+  r = jsmn_unescape(js, &t[6], js + t[6].start, t[6].end - t[6].start);
+  check(r == 21);
+  check(strncmp(js + t[6].start, "0123456789abcdef\tghij", 21) == 0);
+  r = jsmn_unescape(js, &t[2], js + t[2].start, t[2].end - t[2].start);
+  check(r == 7);
+  check(strncmp(js + t[2].start, "a\\n\"b\\/", 7) == 0);
+
+#ifdef JSMN_ESCAPE_FLAGS
+  check(!t[1].escaped && t[2].escaped && t[3].escaped && t[6].escaped);
+  check(!t[0].escaped);
+
+  /* The flag survives a string cut off by the end of data */
+  strcpy(js, "[\"ab\\u00e9\", \"cd\"]");
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, 6, t, 8) == JSMN_ERROR_PART);
+  check(jsmn_parse(&p, js, strlen(js), t, 8) == 3);
+  check(t[1].escaped && !t[2].escaped);
+#endif
+  return 0;
+}
+
+int test_lines(void) {
+  int r;
+  jsmn_parser p;
+  jsmntok_t t[8];
+  jsmn_record rec[4];
+  jsmnuint_t b[5];
+  const char *js = "{\"a\": 1}\n"
+                   "\n"
+                   "[1, 2\n"
+                   "  \"s\"\r\n"
+                   "{\"b\": {\"c\": [null, true, false]}}\n"
+                   "[7]";
+
+  jsmn_init(&p);
+  check(jsmn_parse_lines(&p, js, strlen(js), NULL, 8, rec, 4) ==
+        JSMN_ERROR_INVAL);
+  check(jsmn_parse_lines(&p, js, strlen(js), t, 8, NULL, 4) ==
+        JSMN_ERROR_INVAL);
+  check(p.pos == 0);
+  r = jsmn_parse_lines(&p, js, strlen(js), t, 8, rec, 4);
+  check(r == 3);
+  check(rec[0].token == 0 && rec[0].count == 3 && rec[0].error == 0);
+  check(rec[0].start == 0 && rec[0].end == 8);
+  check(tokeq(js, t, 3, JSMN_OBJECT, 0, 8, 1, JSMN_STRING, "a", 1,
+              JSMN_PRIMITIVE, "1"));
+  /* A broken record has no tokens and doesn't affect the next one */
+  check(rec[1].count == 0 && rec[1].error == JSMN_ERROR_PART);
+  check(rec[1].start == 10 && rec[1].end == 15);
+  check(rec[2].token == 3 && rec[2].count == 1 && rec[2].error == 0);
+  check(tokeq(js, t + 3, 1, JSMN_STRING, "s", 0));
+
+  /* The next record doesn't fit after the others, so a new call starts it */
+  r = jsmn_parse_lines(&p, js, strlen(js), t, 8, rec, 4);
+  check(r == 1);
+  check(rec[0].token == 0 && rec[0].count == 8 && rec[0].error == 0);
+  check(tokeq(js, t, 8, JSMN_OBJECT, 23, 56, 1, JSMN_STRING, "b", 1,
+              JSMN_OBJECT, 29, 55, 1, JSMN_STRING, "c", 1, JSMN_ARRAY, 35,
+              54, 3, JSMN_PRIMITIVE, "null", JSMN_PRIMITIVE, "true",
+              JSMN_PRIMITIVE, "false"));
+  r = jsmn_parse_lines(&p, js, strlen(js), t, 8, rec, 4);
+  check(r == 1);
+  check(rec[0].token == 0 && rec[0].start == 57 && rec[0].end == 60);
+  check(rec[0].count == 2 && rec[0].error == 0);
+  check(jsmn_parse_lines(&p, js, strlen(js), t, 8, rec, 4) == 0);
+
+  /* Parts for parsing in parallel start at the beginning of a line */
+  jsmn_split_lines(js, strlen(js), b, 4);
+  check(b[0] == 0 && b[1] == 16 && b[2] == 57 && b[3] == 57 && b[4] == 60);
+  jsmn_split_lines(js, 9, b, 3);
+  check(b[0] == 0 && b[1] == 9 && b[2] == 9 && b[3] == 9);
+  jsmn_init(&p);
+  p.pos = b[1];
+  check(jsmn_parse_lines(&p, js, b[2], t, 8, rec, 4) == 0);
+
+  /* A record larger than the tokens array */
+  jsmn_init(&p);
+  check(jsmn_parse_lines(&p, js + 22, strlen(js + 22), t, 4, rec, 4) ==
+        JSMN_ERROR_NOMEM);
+  return 0;
+}
+
+/* Offset of the first comma of the top-level array at or after start */
+static size_t array_comma(const char *js, size_t len, size_t start) {
+  size_t pos;
+  int depth = 0, instring = 0;
+
+  for (pos = 0; pos < len; pos++) {
+    if (instring) {
+      if (js[pos] == '\\') {
+        pos++;
+      } else if (js[pos] == '\"') {
+        instring = 0;
+      }
+    } else if (js[pos] == '\"') {
+      instring = 1;
+    } else if (js[pos] == '[' || js[pos] == '{') {
+      depth++;
+    } else if (js[pos] == ']' || js[pos] == '}') {
+      depth--;
+    } else if (js[pos] == ',' && depth == 1 && pos >= start) {
+      return pos;
+    }
+  }
+  return len;
+}
+
+int test_parallel_array(void) {
+  int i, k, r, n, d;
+  size_t comma;
+  jsmn_parser p;
+  jsmntok_t t[64], whole[64], part[64];
+  jsmn_chunk c[8];
+  const char *docs[2] = {
+      "[{\"a\": [1, 2]}, \"x\\\",]\", [[\"[\"], {}],\n"
+      " {\"b\": \"\\\\\"}, 3, [], \"}\", {\"c\": {\"d\": null}}]",
+      "[[[[1, 2], [3, 4], {\"a\": [5, 6, 7, 8, 9]}], 10, 11], \"[,[,[,\", "
+      "12, {\"b\": [[13, 14], [15, [16, 17, {\"c\": 18}]]], \"d\": \"\\\"]\"}, "
+      "[19, 20], 21]"};
+  const char *js;
+  size_t len;
+
+  for (d = 0; d < 2; d++) {
+    js = docs[d];
+    len = strlen(js);
+    /* Tokens are compared as bytes, padding included */
+    memset(t, 0, sizeof(t));
+    memset(whole, 0, sizeof(whole));
+    memset(part, 0, sizeof(part));
+    jsmn_init(&p);
+    r = jsmn_parse(&p, js, len, t, 64);
+    check(r == (d == 0 ? 22 : 41));
+
+    for (n = 1; n <= 8; n++) {
+      /* Evenly spaced chunks, each scanned on its own */
+      for (i = 0; i < n; i++) {
+        c[i].start = (jsmnuint_t)(len * i / n);
+        c[i].end = (jsmnuint_t)(len * (i + 1) / n);
+        jsmn_scan_chunk(js, len, &c[i]);
+      }
+      check(jsmn_split_array(js, len, c, n) == 0);
+      for (i = n - 1; i > 0; i--) {
+        /* Right after the first comma of the array in the chunk */
+        comma = array_comma(js, len, c[i].start);
+        if (comma < c[i].end) {
+          check(c[i].split == comma + 1);
+        } else {
+          check(c[i].split == (i + 1 < n ? c[i + 1].split : len));
+        }
+      }
+      k = 0;
+      for (i = 0; i < n; i++) {
+        int m = jsmn_parse_array_part(&p, js, len, c, n, i, part, 64);
+        check(m > 0);
+        k = jsmn_join_array_part(whole, 64, k, part, m);
+      }
+      check(k == r);
+      check(memcmp(whole, t, r * sizeof(jsmntok_t)) == 0);
+    }
+  }
+
+  c[0].start = 0;
+  c[0].end = 4;
+  jsmn_scan_chunk("{\"a\"", 4, &c[0]);
+  check(jsmn_split_array("{\"a\"", 4, c, 1) == JSMN_ERROR_INVAL);
+  return 0;
+}
+
+int test_skip_links(void) {
+#ifdef JSMN_SKIP_LINKS
+  int i, n;
+  jsmn_parser p;
+  jsmntok_t t[16];
+  const char *js =
+      "{\"a\": [1, {\"b\": 2}], \"c\": {}, \"d\": \"e\", \"f\": [[3]]}";
+
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), t, 16) == 15);
+  check(t[0].next == 15);
+  check(t[1].next == 2 && t[2].next == 7);
+  check(t[3].next == 4 && t[4].next == 7 && t[6].next == 7);
+  check(t[8].next == 9);
+  check(t[12].next == 15 && t[13].next == 15 && t[14].next == 15);
+
+  /* Walk the keys of the root object without visiting the values */
+  n = 0;
+  for (i = 1; i < t[0].next; i = t[i + 1].next) {
+    check(t[i].type == JSMN_STRING && t[i].size == 1);
+    n++;
+  }
+  check(n == t[0].size);
+#endif
+  return 0;
+}
+
+int test_large_input(void) {
+#ifdef TEST_LARGE_INPUT
+  /* A 4.3 GiB document with one huge string, built from a 1 MiB file mapped
+   * over and over, so it takes address space but hardly any memory */
+  const size_t mib = (size_t)1 << 20;
+  const size_t len = 4400 * mib;
+  const char *head = "[0, \"";
+  const char *tail = "\", \"end\", 1]";
+  char *js, *chars;
+  FILE *f;
+  size_t i;
+  jsmn_parser p;
+  jsmntok_t t[5];
+
+  chars = malloc(mib);
+  f = tmpfile();
+  check(chars != NULL && f != NULL);
+  memset(chars, 'x', mib);
+  check(fwrite(chars, 1, mib, f) == mib && fflush(f) == 0);
+  free(chars);
+
+  js = mmap(NULL, len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  check(js != MAP_FAILED);
+  for (i = 1; i + 1 < len / mib; i++) {
+    check(mmap(js + i * mib, mib, PROT_READ, MAP_SHARED | MAP_FIXED,
+               fileno(f), 0) != MAP_FAILED);
+  }
+  memset(js, 'x', mib);
+  memcpy(js, head, strlen(head));
+  memset(js + len - mib, 'x', mib);
+  memcpy(js + len - strlen(tail), tail, strlen(tail));
+
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, len, t, 5) == 5);
+  check(t[0].type == JSMN_ARRAY && t[0].start == 0 && t[0].size == 4);
+  check((size_t)t[0].end == len);
+  check(t[2].type == JSMN_STRING && t[2].start == (jsmnint_t)strlen(head));
+  check((size_t)t[2].end == len - strlen(tail));
+  check(t[3].type == JSMN_STRING && t[3].end - t[3].start == 3);
+  check((size_t)t[3].start == len - strlen(tail) + 4);
+  check(t[4].type == JSMN_PRIMITIVE && (size_t)t[4].end == len - 1);
+#ifdef JSMN_PARENT_LINKS
+  check(t[4].parent == 0);
+#endif
+#ifdef JSMN_SKIP_LINKS
+  check(t[0].next == 5 && t[2].next == 3);
+#endif
+
+  munmap(js, len);
+  fclose(f);
+#endif
+  return 0;
+}
+
+int test_stats(void) {
+#ifdef JSMN_STATS
+  jsmn_parser p;
+  jsmntok_t t[16];
+  const char *js = "{\"a\": [1, 2, {\"b\": null}], \"c\": \"d\"}";
+  const char *lines = "[1, 2, 3]\n[4]\n";
+  jsmn_record rec[4];
+
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), t, 16) == 10);
+  check(p.stats.tokens[JSMN_OBJECT] == 2 && p.stats.tokens[JSMN_ARRAY] == 1);
+  check(p.stats.tokens[JSMN_STRING] == 4);
+  check(p.stats.tokens[JSMN_PRIMITIVE] == 3);
+  check(p.stats.max_depth == 3 && p.stats.bytes == strlen(js));
+  check(p.stats.rescanned == 0 && p.stats.restarts == 0);
+#if defined(JSMN_MAX_DEPTH)
+  check(p.stats.scan_steps == 0);
+#elif defined(JSMN_PARENT_LINKS)
+  check(p.stats.scan_steps == 7);
+#else
+  check(p.stats.scan_steps > 7);
+#endif
+
+  /* Data passed in parts, cut in the middle of a string */
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, 3, t, 16) == JSMN_ERROR_PART);
+  check(jsmn_parse(&p, js, 12, t, 16) == JSMN_ERROR_PART);
+  check(jsmn_parse(&p, js, strlen(js), t, 16) == 10);
+  check(p.stats.restarts == 2 && p.stats.bytes == strlen(js));
+  check(p.stats.rescanned == 0);
+
+  /* The second record doesn't fit and is parsed again by the next call, its
+   * array is counted twice */
+  jsmn_init(&p);
+  check(jsmn_parse_lines(&p, lines, strlen(lines), t, 5, rec, 4) == 1);
+  check(jsmn_parse_lines(&p, lines, strlen(lines), t, 5, rec, 4) == 1);
+  check(p.stats.bytes == strlen(lines) + 2 && p.stats.rescanned == 2);
+  check(p.stats.restarts == 0 && p.stats.tokens[JSMN_ARRAY] == 3);
+
+  /* Without tokens objects and arrays are counted, but not their depth */
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), NULL, 0) == 10);
+  check(p.stats.tokens[JSMN_OBJECT] == 2 && p.stats.tokens[JSMN_STRING] == 4);
+  check(p.stats.max_depth == 0 && p.stats.scan_steps == 0);
+#endif
+  return 0;
+}
+
+int test_next_element(void) {
+  int r;
+  int n = 0;
+  unsigned long fed = 0;
+  unsigned int used = 0;
+  char win[16];
+  jsmn_parser p;
+  jsmntok_t t[5];
+  const char *js = "[{\"a\": [1, 2]}, \"x\\\"y\", 123, [], true]";
+
+  /* Elements are only parsed into tokens */
+  jsmn_init(&p);
+  check(jsmn_parse_next_element(&p, js, strlen(js), NULL, 0) ==
+        JSMN_ERROR_INVAL);
+  check(jsmn_parse_next_element(&p, "[1", 2, NULL, 0) == JSMN_ERROR_INVAL);
+
+  /* Feed the array byte by byte through a small window, dropping every
+   * element as soon as it has been parsed */
+  jsmn_init(&p);
+  for (;;) {
+    r = jsmn_parse_next_element(&p, win, used, t, 5);
+    if (r == JSMN_ERROR_PART) {
+      check(fed < strlen(js) && used < sizeof(win));
+      win[used++] = js[fed++];
+      continue;
+    }
+    if (r == 0) {
+      break;
+    }
+    switch (n++) {
+    case 0:
+      check(r == 5);
+      check(tokeq(win, t, 5, JSMN_OBJECT, -1, -1, 1, JSMN_STRING, "a", 1,
+                  JSMN_ARRAY, -1, -1, 2, JSMN_PRIMITIVE, "1", JSMN_PRIMITIVE,
+                  "2"));
+      break;
+    case 1:
+      check(r == 1);
+      check(tokeq(win, t, 1, JSMN_STRING, "x\\\"y", 0));
+      break;
+    case 2:
+      check(r == 1);
+      check(tokeq(win, t, 1, JSMN_PRIMITIVE, "123"));
+      break;
+    case 3:
+      check(r == 1);
+      check(tokeq(win, t, 1, JSMN_ARRAY, -1, -1, 0));
+      break;
+    case 4:
+      check(r == 1);
+      check(tokeq(win, t, 1, JSMN_PRIMITIVE, "true"));
+      break;
+    default:
+      check(0);
+    }
+    memmove(win, win + p.pos, used - p.pos);
+    used -= p.pos;
+    p.pos = 0;
+  }
+  check(n == 5 && fed == strlen(js));
+  check(jsmn_parse_next_element(&p, win, used, t, 5) == 0);
+
+  jsmn_init(&p);
+  check(jsmn_parse_next_element(&p, "{}", 2, t, 5) == JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_next_element(&p, "[1 2]", 5, t, 5) == 1);
+  check(jsmn_parse_next_element(&p, "[1 2]", 5, t, 5) == JSMN_ERROR_INVAL);
+  return 0;
+}
+
+#ifdef JSMN_MAX_DEPTH
+static char events[256];
+static const char *events_js;
+
+static void event_add(const char *tag, jsmnint_t start, jsmnint_t end) {
+  size_t n = strlen(events);
+  sprintf(events + n, "%s%.*s ", tag, (int)(end - start), events_js + start);
+}
+
+static int on_begin(void *user, jsmntype_t type, jsmnint_t start) {
+  (void)user;
+  event_add(type == JSMN_OBJECT ? "{" : "[", start, start);
+  return 0;
+}
+
+static int on_end(void *user, jsmntype_t type, jsmnint_t end) {
+  (void)user;
+  event_add(type == JSMN_OBJECT ? "}" : "]", end, end);
+  return 0;
+}
+
+static int on_key(void *user, jsmnint_t start, jsmnint_t end) {
+  (void)user;
+  event_add("k:", start, end);
+  return 0;
+}
+
+static int on_string(void *user, jsmnint_t start, jsmnint_t end) {
+  (void)user;
+  event_add("s:", start, end);
+  return 0;
+}
+
+static int on_primitive(void *user, jsmnint_t start, jsmnint_t end) {
+  event_add("p:", start, end);
+  return *(int *)user;
+}
+#endif
+
+int test_events(void) {
+#ifdef JSMN_MAX_DEPTH
+  int r;
+  int stop = 0;
+  unsigned long i;
+  jsmn_parser p;
+  jsmn_callbacks cb = {on_begin, on_end, on_key, on_string, on_primitive};
+  const char *js = "{\"a\": [1, \"b\\n\", {}], \"c\": {\"d\": null}}";
+  const char *expected = "{ k:a [ p:1 s:b\\n { } ] k:c { k:d p:null } } ";
+
+  events_js = js;
+  events[0] = '\0';
+  jsmn_init(&p);
+  r = jsmn_parse_events(&p, js, strlen(js), &cb, &stop);
+  check(r == 10 && strcmp(events, expected) == 0);
+  jsmn_init(&p);
+  check(jsmn_parse(&p, js, strlen(js), NULL, 0) == r);
+
+  /* Values cut off by the end of input are reported once they are complete */
+  events[0] = '\0';
+  jsmn_init(&p);
+  for (i = 1; i < strlen(js); i++) {
+    check(jsmn_parse_events(&p, js, i, &cb, &stop) == JSMN_ERROR_PART);
+  }
+  check(jsmn_parse_events(&p, js, strlen(js), &cb, &stop) == 10);
+  check(strcmp(events, expected) == 0);
+
+  /* A callback can stop the parser, whatever it returns */
+  stop = 1;
+  events[0] = '\0';
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, js, strlen(js), &cb, &stop) == JSMN_ERROR_STOP);
+  check(strcmp(events, "{ k:a [ p:1 ") == 0);
+
+  stop = 0;
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "[1}", 3, &cb, &stop) == JSMN_ERROR_INVAL);
+#ifdef JSMN_STRICT
+  /* Only a comma or the end of the object may follow a value in it */
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{1: 2}", 6, &cb, &stop) == JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{\"a\":1 2}", 9, &cb, &stop) ==
+        JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{\"a\":true false}", 16, &cb, &stop) ==
+        JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{\"a\":[] 1}", 10, &cb, &stop) ==
+        JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{\"a\":{} {}}", 11, &cb, &stop) ==
+        JSMN_ERROR_INVAL);
+  jsmn_init(&p);
+  check(jsmn_parse_events(&p, "{\"a\":1, \"b\":[]}", 15, &cb, &stop) == 5);
+#endif
+#endif
+  return 0;
+}
+
+int test_writer(void) {
+  int r;
+  int grown = 0;
+  jsmn_parser p;
+  jsmntok_t t[16];
+  jsmn_writer w;
+  char buf[16];
+  const char *s = "plain text that is long enough for vectors\x01 \"q\" \\ "
+                  "\b\f\n\r\t\x1f\x7f\xc3\xa9 end";
+
+  jsmn_writer_init(&w, NULL, 0, test_grow, &grown);
+  check(jsmn_write_begin_object(&w) == 0);
+  jsmn_write_key(&w, "a", 1);
+  jsmn_write_begin_array(&w);
+  jsmn_write_bool(&w, 1);
+  jsmn_write_null(&w);
+  jsmn_write_begin_object(&w);
+  jsmn_write_end_object(&w);
+  jsmn_write_begin_array(&w);
+  jsmn_write_end_array(&w);
+  jsmn_write_double(&w, -2.5);
+  jsmn_write_end_array(&w);
+  jsmn_write_key(&w, "k\"ey", 4);
+  jsmn_write_string(&w, s, strlen(s));
+  jsmn_write_key(&w, "raw", 3);
+  jsmn_write_raw(&w, "[1, 2]", 6);
+  check(jsmn_write_end_object(&w) == 0);
+  check(w.error == 0 && w.depth == 0 && grown == 3);
+  check(w.len == 133);
+  check(strncmp(w.buf,
+                "{\"a\":[true,null,{},[],-2.5],\"k\\\"ey\":\"plain text that "
+                "is long enough for vectors\\u0001 \\\"q\\\" \\\\ "
+                "\\b\\f\\n\\r\\t\\u001f\x7f\xc3\xa9 end\",\"raw\":[1, 2]}",
+                w.len) == 0);
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, w.buf, w.len, t, 16);
+  check(r == 14);
+  check(jsmn_unescape(w.buf, &t[9], w.buf + t[9].start,
+                      t[9].end - t[9].start) == (jsmnint_t)strlen(s));
+  check(strncmp(w.buf + t[9].start, s, strlen(s)) == 0);
+  free(w.buf);
+
+  /* A fixed buffer, the first error sticks */
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  jsmn_write_begin_array(&w);
+  jsmn_write_string(&w, "012345678", 9);
+  check(jsmn_write_string(&w, "a", 1) == 0 && w.len == 16);
+  check(jsmn_write_null(&w) == JSMN_ERROR_NOMEM);
+  check(jsmn_write_end_array(&w) == JSMN_ERROR_NOMEM && w.len == 16);
+  check(strncmp(buf, "[\"012345678\",\"a\"", 16) == 0);
+
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  check(jsmn_write_end_object(&w) == JSMN_ERROR_INVAL);
+  check(jsmn_write_null(&w) == JSMN_ERROR_INVAL && w.len == 0);
+  return 0;
+}
+
+int test_writer_numbers(void) {
+  jsmn_writer w;
+  char buf[512];
+  double zero = 0;
+
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  jsmn_write_begin_array(&w);
+  jsmn_write_double(&w, 0);
+  jsmn_write_double(&w, -zero);
+  jsmn_write_double(&w, 1);
+  jsmn_write_double(&w, 0.1);
+  jsmn_write_double(&w, 0.3);
+  jsmn_write_double(&w, 1 / 3.0);
+  jsmn_write_double(&w, -1234.5678);
+  jsmn_write_double(&w, 9007199254740992.0);
+  jsmn_write_double(&w, 1e20);
+  jsmn_write_double(&w, 1e21);
+  jsmn_write_double(&w, 123456789012345680000.0);
+  jsmn_write_double(&w, 1e-6);
+  jsmn_write_double(&w, 1.5e-7);
+  jsmn_write_double(&w, 1e23);
+  jsmn_write_double(&w, 5e-324);
+  jsmn_write_double(&w, DBL_MAX);
+  jsmn_write_double(&w, 2.2250738585072014e-308);
+  jsmn_write_double(&w, 2.225073858507201e-308);
+  jsmn_write_double(&w, 8.98846567431158e307);
+  jsmn_write_end_array(&w);
+  check(w.error == 0);
+  check(w.len == 235);
+  check(strncmp(buf,
+                "[0,-0,1,0.1,0.3,0.3333333333333333,-1234.5678,"
+                "9007199254740992,100000000000000000000,1e+21,"
+                "123456789012345680000,0.000001,1.5e-7,1e+23,5e-324,"
+                "1.7976931348623157e+308,2.2250738585072014e-308,"
+                "2.225073858507201e-308,8.98846567431158e+307]",
+                w.len) == 0);
+  check(jsmn_write_double(&w, zero / zero) == JSMN_ERROR_INVAL);
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  check(jsmn_write_double(&w, 1 / zero) == JSMN_ERROR_INVAL && w.len == 0);
+
+#ifdef JSMN_HAS_INT64
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  jsmn_write_begin_array(&w);
+  jsmn_write_int64(&w, 0);
+  jsmn_write_int64(&w, -7);
+  jsmn_write_int64(&w, 1234567890123);
+  jsmn_write_int64(&w, INT64_MAX);
+  jsmn_write_int64(&w, INT64_MIN);
+  jsmn_write_uint64(&w, UINT64_MAX);
+  jsmn_write_end_array(&w);
+  check(w.error == 0);
+  check(w.len == 82);
+  check(strncmp(buf,
+                "[0,-7,1234567890123,9223372036854775807,"
+                "-9223372036854775808,18446744073709551615]",
+                w.len) == 0);
+#endif
+  return 0;
+}
+
+/* Parses js, applies the edits and compares the result with expected */
+static int patched(const char *js, jsmn_patch *patches, unsigned int n,
+                   const char *expected) {
+  jsmn_parser p;
+  jsmntok_t t[16];
+  jsmn_writer w;
+  char buf[64];
+  jsmnint_t r;
+
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 16);
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  if (r <= 0 || jsmn_write_patched(&w, js, t, r, patches, n) != 0) {
+    return 1;
+  }
+  return w.len != strlen(expected) || strncmp(buf, expected, w.len) != 0;
+}
+
+int test_patch(void) {
+  const char *js = "{\"a\": 1, \"b\": [1, 2], \"c\": \"x\"}";
+  jsmn_parser p;
+  jsmntok_t t[16];
+  jsmn_writer w;
+  char buf[64];
+  jsmnint_t r;
+  jsmn_patch e[4] = {{JSMN_PATCH_INSERT, 0, "d", 1, "true", 4, 0, 0},
+                     {JSMN_PATCH_DELETE, 7, NULL, 0, NULL, 0, 0, 0},
+                     {JSMN_PATCH_REPLACE, 2, NULL, 0, "42", 2, 0, 0},
+                     {JSMN_PATCH_INSERT, 4, NULL, 0, "3", 1, 0, 0}};
+  jsmn_patch del[3] = {{JSMN_PATCH_DELETE, 1, NULL, 0, NULL, 0, 0, 0},
+                       {JSMN_PATCH_DELETE, 3, NULL, 0, NULL, 0, 0, 0},
+                       {JSMN_PATCH_DELETE, 2, NULL, 0, NULL, 0, 0, 0}};
+  jsmn_patch ins[2] = {{JSMN_PATCH_INSERT, 0, "k\"", 2, "4", 1, 0, 0},
+                       {JSMN_PATCH_INSERT, 0, "", 0, "5", 1, 0, 0}};
+
+  check(patched(js, e, 0, js) == 0);
+  check(patched(js, e, 4, "{\"a\": 42, \"b\": [1, 2,3],\"d\":true}") == 0);
+  check(e[1].from == 20 && e[1].to == 30);
+
+  /* Commas of deleted members, whitespace of the rest stays */
+  check(patched("{\n  \"a\": 1,\n  \"b\": 2\n}", del, 1,
+                "{\n  \"b\": 2\n}") == 0);
+  check(patched("{\n  \"a\": 1,\n  \"b\": 2\n}", del + 1, 1,
+                "{\n  \"a\": 1\n}") == 0);
+  check(patched("[1, 2, 3]", del, 3, "[]") == 0);
+  check(patched("[1, 2, 3]", del + 1, 2, "[1]") == 0);
+  check(patched("[1, 2, 3]", del + 2, 1, "[1, 3]") == 0);
+  check(patched("[1, 2, 3]", del, 2, "[2]") == 0);
+  check(patched("{\"a\": 1, \"b\": 2}", del, 2, "{}") == 0);
+  check(patched("{\"a\": 1, \"b\": 2}", del, 1, "{\"b\": 2}") == 0);
+
+  /* Inserts after deleted members and into empty objects */
+  check(patched("{ }", ins, 2, "{\"k\\\"\":4,\"\":5 }") == 0);
+  del[1].token = 0;
+  del[1].op = JSMN_PATCH_INSERT;
+  del[1].key = "z";
+  del[1].key_len = 1;
+  del[1].value = "[]";
+  del[1].value_len = 2;
+  check(patched("{\"a\": 1, \"b\": 2}", del, 2, "{\"b\": 2,\"z\":[]}") == 0);
+  check(patched("{\"a\": 1}", del, 2, "{\"z\":[]}") == 0);
+  check(patched("[[1], 2]", ins + 1, 1, "[[1], 2,5]") == 0);
+
+  /* Documents are values of the writer */
+  jsmn_init(&p);
+  r = jsmn_parse(&p, js, strlen(js), t, 16);
+  check(r == 9);
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  jsmn_write_begin_array(&w);
+  jsmn_write_patched(&w, js, t + 4, 3, NULL, 0);
+  jsmn_write_patched(&w, js, t + 8, 1, NULL, 0);
+  check(jsmn_write_end_array(&w) == 0);
+  check(w.len == 12 && strncmp(buf, "[[1, 2],\"x\"]", 12) == 0);
+
+  /* Overlapping edits, values of objects, the root, strings */
+  e[0].op = JSMN_PATCH_DELETE;
+  e[0].token = 1;
+  jsmn_writer_init(&w, buf, sizeof(buf), NULL, NULL);
+  check(jsmn_write_patched(&w, js, t, r, e, 3) == JSMN_ERROR_INVAL);
+  check(w.len == 0 && w.error == JSMN_ERROR_INVAL);
+  e[0].token = 2;
+  check(patched(js, e, 1, js) != 0);
+  e[0].token = 0;
+  check(patched(js, e, 1, js) != 0);
+  e[0].op = JSMN_PATCH_INSERT;
+  e[0].token = 1;
+  check(patched(js, e, 1, js) != 0);
+  e[0].token = 0;
+  e[0].key = NULL;
+  check(patched(js, e, 1, js) != 0);
+  e[0].token = 9;
+  check(patched(js, e, 1, js) != 0);
+  return 0;
+}
+
 int main(void) {
   test(test_empty, "test for a empty JSON objects/arrays");
   test(test_object, "test for a JSON objects");
   test(test_array, "test for a JSON arrays");
   test(test_primitive, "test primitive JSON data types");
   test(test_string, "test string JSON data types");
+  test(test_long_string, "test long JSON strings");
 
   test(test_partial_string, "test partial JSON string parsing");
+  test(test_partial_resume, "test resuming partial strings");
   test(test_partial_array, "test partial array reading");
   test(test_array_nomem, "test array reading with a smaller number of tokens");
+  test(test_array_realloc, "test growing the tokens array while parsing");
   test(test_unquoted_keys, "test unquoted keys (like in JavaScript)");
   test(test_input_length, "test strings that are not null-terminated");
   test(test_issue_22, "test issue #22");
@@ -354,6 +1578,25 @@ int main(void) {
   test(test_nonstrict, "test for non-strict mode");
   test(test_unmatched_brackets, "test for unmatched brackets");
   test(test_object_key, "test for key type");
+  test(test_max_depth, "test for nesting depth limit");
+  test(test_large_size, "test containers with many children");
+  test(test_structurals, "test parsing over structural characters index");
+  test(test_measure, "test measuring token count and depth");
+  test(test_find_path, "test finding values by JSON Pointer");
+  test(test_index, "test looking up object keys in a hash index");
+  test(test_numbers, "test converting number tokens");
+  test(test_long_numbers, "test converting long and rounded numbers");
+  test(test_unescape, "test decoding escape sequences of strings");
+  test(test_lines, "test parsing newline-delimited JSON");
+  test(test_parallel_array, "test parsing parts of an array separately");
+  test(test_large_input, "test offsets beyond 4 GiB");
+  test(test_stats, "test parser instrumentation counters");
+  test(test_skip_links, "test links past the last child of a token");
+  test(test_next_element, "test parsing top-level array elements one by one");
+  test(test_events, "test parsing with callbacks instead of tokens");
+  test(test_writer, "test writing JSON into a buffer");
+  test(test_writer_numbers, "test writing numbers");
+  test(test_patch, "test writing documents with edits");
   printf("\nPASSED: %d\nFAILED: %d\n", test_passed, test_failed);
   return (test_failed > 0);
 }
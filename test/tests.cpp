@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "../jsmn_bind.hpp"
+#include "test.h"
+
+/* In header.cpp */
+jsmnint_t decode_origin(const char *js, int *x, int *y);
+
+struct account {
+  std::string_view name;
+  bool admin = false;
+  int uid = -1;
+  std::vector<std::string_view> groups;
+};
+
+template <> struct jsmn::schema<account> {
+  static constexpr auto fields = jsmn::fields(
+      jsmn::member("user", &account::name), JSMN_MEMBER(account, admin),
+      JSMN_MEMBER(account, uid), JSMN_MEMBER(account, groups));
+};
+
+struct point {
+  double x = 0, y = 0;
+};
+
+template <> struct jsmn::schema<point> {
+  static constexpr auto fields =
+      jsmn::fields(JSMN_MEMBER(point, x), JSMN_MEMBER(point, y));
+};
+
+struct shape {
+  std::string name;
+  std::vector<point> points;
+  std::optional<point> center;
+  std::optional<unsigned char> color;
+  long long id = 0;
+};
+
+template <> struct jsmn::schema<shape> {
+  static constexpr auto fields = jsmn::fields(
+      JSMN_MEMBER(shape, name), JSMN_MEMBER(shape, points),
+      JSMN_MEMBER(shape, center), JSMN_MEMBER(shape, color),
+      JSMN_MEMBER(shape, id));
+};
+
+struct wide {
+  int a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q;
+};
+
+template <> struct jsmn::schema<wide> {
+  static constexpr auto fields = jsmn::fields(
+      JSMN_MEMBER(wide, a), JSMN_MEMBER(wide, b), JSMN_MEMBER(wide, c),
+      JSMN_MEMBER(wide, d), JSMN_MEMBER(wide, e), JSMN_MEMBER(wide, f),
+      JSMN_MEMBER(wide, g), JSMN_MEMBER(wide, h), JSMN_MEMBER(wide, i),
+      JSMN_MEMBER(wide, j), JSMN_MEMBER(wide, k), JSMN_MEMBER(wide, l),
+      JSMN_MEMBER(wide, m), JSMN_MEMBER(wide, n), JSMN_MEMBER(wide, o),
+      JSMN_MEMBER(wide, p), JSMN_MEMBER(wide, q));
+};
+
+#if __cplusplus >= 202002L
+/* Compares compile-time tokens with those of jsmn_parse() */
+template <std::size_t N>
+static bool same_tokens(const char *js, const jsmn::static_tokens<N> &s) {
+  jsmntok_t t[N] = {};
+  jsmn_parser p;
+
+  jsmn_init(&p);
+  if (jsmn_parse(&p, js, strlen(js), t, N) != s.count) {
+    return false;
+  }
+  for (std::size_t i = 0; i < N; i++) {
+    const jsmntok_t &a = t[i], &b = s.tokens[i];
+    if (a.type != b.type || a.start != b.start || a.end != b.end ||
+        a.size != b.size) {
+      return false;
+    }
+#ifdef JSMN_PARENT_LINKS
+    if (a.parent != b.parent) {
+      return false;
+    }
+#endif
+#ifdef JSMN_SKIP_LINKS
+    if (a.next != b.next) {
+      return false;
+    }
+#endif
+#ifdef JSMN_ESCAPE_FLAGS
+    if (a.escaped != b.escaped) {
+      return false;
+    }
+#endif
+  }
+  return true;
+}
+
+#define check_static(n, js)                                                    \
+  do {                                                                         \
+    static constexpr auto s = jsmn::parse_static<n>(js);                       \
+    check(same_tokens(js, s));                                                 \
+  } while (0)
+#endif
+
+int test_bind_object(void) {
+  const char *js = "{\"user\": \"johndoe\", \"admin\": true, \"uid\": 1000,\n"
+                   " \"groups\": [\"users\", \"wheel\", \"audio\"]}";
+  jsmntok_t t[16];
+  account a;
+
+  check(jsmn::parse(js, strlen(js), t, 16, a) == 12);
+  check(a.name == "johndoe");
+  check(a.admin);
+  check(a.uid == 1000);
+  check(a.groups.size() == 3);
+  check(a.groups[0] == "users" && a.groups[2] == "audio");
+  return 0;
+}
+
+int test_bind_nested(void) {
+  const char *js = "{\"id\": -5, \"extra\": {\"id\": [1, {\"x\": 2}]},"
+                   " \"points\": [{\"x\": 1, \"y\": 2.5}, {\"y\": -1e2}],"
+                   " \"center\": null, \"name\": \"tri\\u0041ngle\\n\","
+                   " \"color\": 200}";
+  jsmntok_t t[32];
+  shape s;
+
+  s.center = point();
+  check(jsmn::parse(js, strlen(js), t, 32, s) > 0);
+  check(s.id == -5);
+  check(s.name == "triAngle\n");
+  check(s.points.size() == 2);
+  check(s.points[0].x == 1 && s.points[0].y == 2.5);
+  /* Missing keys keep their values */
+  check(s.points[1].x == 0 && s.points[1].y == -100);
+  check(!s.center.has_value());
+  check(s.color == 200);
+  return 0;
+}
+
+int test_bind_errors(void) {
+  jsmntok_t t[8];
+  account a;
+  shape s;
+
+  check(jsmn::parse("{\"uid\": \"1\"}", 12, t, 8, a) == JSMN_ERROR_INVAL);
+  check(jsmn::parse("{\"uid\": 1.5}", 12, t, 8, a) == JSMN_ERROR_INVAL);
+  check(jsmn::parse("{\"uid\": 3000000000}", 19, t, 8, a) ==
+        JSMN_ERROR_RANGE);
+  check(jsmn::parse("{\"admin\": 1}", 12, t, 8, a) == JSMN_ERROR_INVAL);
+  check(jsmn::parse("{\"color\": 256}", 14, t, 8, s) == JSMN_ERROR_RANGE);
+  check(jsmn::parse("{\"color\": -1}", 13, t, 8, s) == JSMN_ERROR_RANGE);
+  check(jsmn::parse("[]", 2, t, 8, a) == JSMN_ERROR_INVAL);
+  check(jsmn::parse("{\"uid\": 1", 9, t, 8, a) == JSMN_ERROR_PART);
+  check(jsmn::parse("  ", 2, t, 8, a) == JSMN_ERROR_PART);
+  check(jsmn::parse("[1, 2, 3, 4, 5, 6, 7, 8]", 24, t, 8, a) ==
+        JSMN_ERROR_NOMEM);
+  return 0;
+}
+
+int test_bind_keys(void) {
+  using b = jsmn::detail::binding<wide>;
+  const char *js = "{\"q\": 17, \"a\": 1, \"aa\": 0, \"b\": 2, \"c\": 3,"
+                   " \"d\": 4, \"e\": 5, \"f\": 6, \"g\": 7, \"h\": 8,"
+                   " \"i\": 9, \"A\": 0, \"j\": 10, \"k\": 11, \"l\": 12,"
+                   " \"m\": 13, \"n\": 14, \"o\": 15, \"\": 0, \"p\": 16}";
+  jsmntok_t t[48];
+  wide w = {};
+
+  static_assert((b::size & (b::size - 1)) == 0, "slots not a power of two");
+  static_assert(b::size >= b::count, "keys share a slot");
+  check(jsmn::parse(js, strlen(js), t, 48, w) == 41);
+  check(w.a == 1 && w.b == 2 && w.c == 3 && w.d == 4 && w.e == 5);
+  check(w.f == 6 && w.g == 7 && w.h == 8 && w.i == 9 && w.j == 10);
+  check(w.k == 11 && w.l == 12 && w.m == 13 && w.n == 14 && w.o == 15);
+  check(w.p == 16 && w.q == 17);
+  return 0;
+}
+
+int test_view_object(void) {
+  const char *js = "{\"a\": [1, [2, {\"x\": 3}]], \"b\": {\"c\": {}},"
+                   " \"s\": \"x\\ty\", \"n\": null, \"t\": true}";
+  jsmntok_t t[32];
+  jsmn_parser p;
+  const char *keys[] = {"a", "b", "s", "n", "t"};
+  jsmntype_t types[] = {JSMN_ARRAY, JSMN_OBJECT, JSMN_STRING, JSMN_PRIMITIVE,
+                        JSMN_PRIMITIVE};
+  int i = 0;
+
+  jsmn_init(&p);
+  jsmn::document doc(js, t, jsmn_parse(&p, js, strlen(js), t, 32));
+  jsmn::object obj = doc.root().as_object();
+  check(obj.size() == 5);
+  for (auto [key, v] : obj) {
+    check(i < 5 && key == keys[i] && v.type() == types[i]);
+    i++;
+  }
+  check(i == 5);
+  check(obj["s"].str() == "x\\ty");
+  check(obj["n"].is_null() && !obj["t"].is_null());
+  check(doc.root()["b"]["c"].is_object());
+  check(doc.root()["b"]["c"].as_object().begin() ==
+        doc.root()["b"]["c"].as_object().end());
+  check(doc.root()["a"][1][1]["x"].as<int>() == 3);
+  /* Missing values all the way down */
+  check(!obj["x"] && obj["x"].type() == JSMN_UNDEFINED);
+  check(!obj["x"]["y"][0] && obj["x"]["y"].as<int>(7) == 7);
+  check(!doc.root()["a"]["x"] && !obj["s"].as_object()["x"]);
+  return 0;
+}
+
+int test_view_array(void) {
+  const char *js = "[[], {\"k\": [0, 0]}, \"s\", 4, [5, [6]], 7]";
+  jsmntok_t t[32];
+  jsmn_parser p;
+  int sum = 0, n = 0;
+
+  jsmn_init(&p);
+  jsmn::document doc(js, t, jsmn_parse(&p, js, strlen(js), t, 32));
+  jsmn::array arr = doc.root().as_array();
+  check(arr.size() == 6);
+  for (jsmn::value v : arr) {
+    sum += v.as<int>();
+    n++;
+  }
+  check(n == 6 && sum == 11);
+  check(arr[0].is_array() && arr[0].size() == 0);
+  check(arr[2].str() == "s" && arr[4][1][0].as<int>() == 6);
+  check(arr[5].as<int>() == 7);
+  check(!arr[6] && !arr[-1]);
+  check(!doc.root()["k"]);
+  check(doc.at(2)["k"].size() == 2 && doc.at(13).as<int>() == 7);
+  check(doc.count() == 14 && !doc.at(14) && !doc.at(-1));
+  check(doc.root().as_object().size() == 0);
+  /* No tokens, no root */
+  check(!jsmn::document(js, t, JSMN_ERROR_PART).root());
+  return 0;
+}
+
+int test_view_getters(void) {
+  const char *js = "[\"a\\u00e9\\n\", 300, -1, 2.5, false, \"9\", 1e400]";
+  jsmntok_t t[16];
+  jsmn_parser p;
+  char buf[16];
+  std::string s = "old";
+  int i = 1;
+  unsigned char c = 1;
+  double d = 0;
+  bool b = true;
+
+  jsmn_init(&p);
+  jsmn::document doc(js, t, jsmn_parse(&p, js, strlen(js), t, 16));
+  jsmn::value v = doc.root();
+  check(v[0].raw() == "a\\u00e9\\n");
+  check(v[0].unescape(buf, sizeof(buf)) == "a\xc3\xa9\n");
+  check(v[1].unescape(buf, sizeof(buf)).empty());
+  check(v[0].get(s) == 0 && s == "a\xc3\xa9\n");
+  check(v[1].get(s) == JSMN_ERROR_INVAL && s == "a\xc3\xa9\n");
+  check(v[1].get(i) == 0 && i == 300);
+  check(v[1].get(c) == JSMN_ERROR_RANGE && c == 1);
+  check(v[2].get(c) == JSMN_ERROR_RANGE && v[2].as<long>() == -1);
+  check(v[3].get(i) == JSMN_ERROR_INVAL && i == 300);
+  check(v[3].get(d) == 0 && d == 2.5);
+  check(v[4].get(b) == 0 && !b && v[4].raw() == "false");
+  check(v[5].as<int>(-7) == -7 && v[5].as<std::string_view>() == "9");
+  check(v[6].get(d) == JSMN_ERROR_RANGE && d == 2.5);
+  check(v[7].get(d) == JSMN_ERROR_INVAL && v[7].raw().empty());
+
+  /* Only true and false are booleans */
+  js = "[true, tru, falsey, 1]";
+  jsmn_init(&p);
+  doc = jsmn::document(js, t, jsmn_parse(&p, js, strlen(js), t, 16));
+  v = doc.root();
+  check(v[0].get(b) == 0 && b);
+  check(v[1].get(b) == JSMN_ERROR_INVAL && b);
+  check(v[2].get(b) == JSMN_ERROR_INVAL && v[3].get(b) == JSMN_ERROR_INVAL);
+  return 0;
+}
+
+int test_static_parse(void) {
+#if __cplusplus >= 202002L
+  static constexpr char js[] = "{\"a\": [1, {\"b\": null}], \"c\": \"x\"}";
+  static constexpr auto doc = jsmn::parse_static<jsmn::count_tokens(js)>(js);
+
+  static_assert(doc.count == 9 && doc.tokens[0].type == JSMN_OBJECT);
+  static_assert(doc.tokens[2].size == 2 && doc.tokens[8].end == 31);
+  check(doc.doc(js).root()["a"][1]["b"].is_null());
+  check(doc.doc(js).root()["c"].str() == "x");
+  check_static(9, js);
+  check_static(4, "[\"\\u00e9\\n\", \"\\\"\", -1.5e3]");
+  check_static(8, "{\"a\": {\"b\": [[], {}]}, \"c\": true}");
+  check_static(4, "[1, 2, 3, 4, 5]");
+  check_static(4, "[1, {\"a\": 2}");
+  check_static(4, "\"abc");
+  check_static(4, "\"\\x\"");
+  check_static(4, "\"\\u12g4\"");
+  check_static(4, "[1, 2]]");
+  check_static(4, "{\"a\" 1}");
+  check_static(4, "{1: 2}");
+  check_static(4, "[1,,2]");
+  check_static(4, "[tru]");
+  check_static(4, "[\"\x01\"]");
+  check_static(2, "  ");
+  check_static(8, "[[[[[[[1]]]]]]]");
+  static_assert(jsmn::count_tokens("[1, {\"a\": 2}, \"s\"]") == 6);
+#endif
+  return 0;
+}
+
+int test_header_unit(void) {
+  int x = 0, y = 0;
+
+  check(decode_origin("{\"x\": 3, \"y\": -4}", &x, &y) == 5);
+  check(x == 3 && y == -4);
+  return 0;
+}
+
+int main(void) {
+  test(test_bind_object, "test decoding an object into a struct");
+  test(test_bind_nested, "test decoding nested structs and containers");
+  test(test_bind_errors, "test decoding values of the wrong type");
+  test(test_bind_keys, "test the perfect hash of schema keys");
+  test(test_view_object, "test iterating over object members");
+  test(test_view_array, "test iterating over array elements");
+  test(test_view_getters, "test converting values of a view");
+  test(test_static_parse, "test parsing at compile time");
+  test(test_header_unit, "test a second unit with JSMN_HEADER");
+  printf("\nPASSED: %d\nFAILED: %d\n", test_passed, test_failed);
+  return (test_failed > 0);
+}
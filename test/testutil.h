@@ -34,16 +34,16 @@ static int vtokeq(const char *s, jsmntok_t *t, unsigned long numtok,
       }
       if (start != -1 && end != -1) {
         if (t[i].start != start) {
-          printf("token %lu start is %d, not %d\n", i, t[i].start, start);
+          printf("token %lu start is %d, not %d\n", i, (int)t[i].start, start);
           return 0;
         }
         if (t[i].end != end) {
-          printf("token %lu end is %d, not %d\n", i, t[i].end, end);
+          printf("token %lu end is %d, not %d\n", i, (int)t[i].end, end);
           return 0;
         }
       }
       if (size != -1 && t[i].size != size) {
-        printf("token %lu size is %d, not %d\n", i, t[i].size, size);
+        printf("token %lu size is %d, not %d\n", i, (int)t[i].size, size);
         return 0;
       }
 
@@ -51,8 +51,8 @@ static int vtokeq(const char *s, jsmntok_t *t, unsigned long numtok,
         const char *p = s + t[i].start;
         if (strlen(value) != (unsigned long)(t[i].end - t[i].start) ||
             strncmp(p, value, t[i].end - t[i].start) != 0) {
-          printf("token %lu value is %.*s, not %s\n", i, t[i].end - t[i].start,
-                 s + t[i].start, value);
+          printf("token %lu value is %.*s, not %s\n", i,
+                 (int)(t[i].end - t[i].start), s + t[i].start, value);
           return 0;
         }
       }